@@ -2,6 +2,20 @@
     return True
 
 
+def get_opts(platform):
+    from SCons.Variables import BoolVariable, PathVariable
+
+    return [
+        BoolVariable("python_static", "Link CPython statically (Linux only; add use_lto=yes for LTO)", False),
+        PathVariable(
+            "python_static_lib",
+            "Path to the static libpython built with --with-lto",
+            "thirdparty/cpython/lib/libpython3.9.a",
+            PathVariable.PathAccept,
+        ),
+    ]
+
+
 def configure(env):
     pass
 
@@ -0,0 +1,49 @@
+#include "godot_module.h"
+#include "py_codec.h"
+#include "py_file_io.h"
+#include "py_multimesh.h"
+#include "py_object.h"
+
+static PyMethodDef godot_methods[] =
+{
+	{ "open", (PyCFunction)file_io_open, METH_VARARGS | METH_KEYWORDS, "open(path, mode='r', encoding='utf-8')\nOpen a res://, user:// or PCK file through Godot's FileAccess." },
+	{ "encode_variant", (PyCFunction)codec_py_encode_variant, METH_O, "encode_variant(obj) -> bytes\nEncode None/bool/int/float/str/bytes/list/tuple/dict in Godot's var2bytes format." },
+	{ "decode_variant", (PyCFunction)codec_py_decode_variant, METH_O, "decode_variant(buffer) -> object\nDecode Godot's var2bytes format." },
+	{ "get_singleton", (PyCFunction)object_proxy_get_singleton, METH_O, "get_singleton(name) -> godot.Object\nGet an engine singleton such as 'OS' or 'Input'." },
+	{ "multimesh_stride", (PyCFunction)multimesh_py_stride, METH_O, "multimesh_stride(multimesh) -> int\nFloats per instance in the MultiMesh bulk array." },
+	{ "multimesh_set_buffer", (PyCFunction)multimesh_py_set_buffer, METH_VARARGS, "multimesh_set_buffer(multimesh, buffer)\nSet every instance from a float32/float64 buffer of instance_count * multimesh_stride floats." },
+	{ NULL, NULL, 0, NULL }
+};
+
+static PyModuleDef godot_module =
+{
+	PyModuleDef_HEAD_INIT,
+	"godot",
+	"Access to the Godot engine.",
+	-1,
+	godot_methods
+};
+
+PyMODINIT_FUNC PyInit_godot(void)
+{
+	PyObject* mod = PyModule_Create(&godot_module);
+	if (!mod)
+		return NULL;
+
+	PyObject* fileIO = file_io_create_type();
+	if (!fileIO || PyModule_AddObject(mod, "FileAccessIO", fileIO) != 0)
+	{
+		Py_XDECREF(fileIO);
+		Py_DECREF(mod);
+		return NULL;
+	}
+
+	PyObject* object = object_proxy_create_type();
+	if (!object || PyModule_AddObject(mod, "Object", object) != 0)
+	{
+		Py_XDECREF(object);
+		Py_DECREF(mod);
+		return NULL;
+	}
+	return mod;
+}
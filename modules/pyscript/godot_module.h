@@ -0,0 +1,10 @@
+#ifndef GODOT_MODULE_H
+#define GODOT_MODULE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// Built-in "godot" Python module, registered with PyImport_AppendInittab before Py_Initialize.
+PyMODINIT_FUNC PyInit_godot(void);
+
+#endif
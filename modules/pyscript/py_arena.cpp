@@ -0,0 +1,176 @@
+#include "py_arena.h"
+#include "core/os/memory.h"
+
+bool PyScratchArena::enabled = true;
+
+static const size_t ARENA_CHUNK_SIZE = 16 * 1024;
+
+static inline uint8_t* arena_align(uint8_t* p_ptr, size_t p_align)
+{
+	return (uint8_t*)(((size_t)p_ptr + p_align - 1) & ~(p_align - 1));
+}
+
+PyScratchArena& PyScratchArena::get()
+{
+	static thread_local PyScratchArena arena;
+	return arena;
+}
+
+void* PyScratchArena::alloc(size_t p_size, size_t p_align)
+{
+	m_used += p_size;
+	if (m_used > m_highWater)
+		m_highWater = m_used;
+
+	if (!enabled)
+	{
+		void* ptr = memalloc(MAX(p_size, (size_t)1));
+		m_heap.push_back(ptr);
+		return ptr;
+	}
+
+	uint8_t* ptr = m_chunks ? arena_align((uint8_t*)(m_chunks + 1) + m_chunks->used, p_align) : NULL;
+	if (ptr && ptr + p_size <= (uint8_t*)(m_chunks + 1) + m_chunks->size)
+	{
+		m_chunks->used = ptr + p_size - (uint8_t*)(m_chunks + 1);
+		return ptr;
+	}
+
+	size_t size = MAX(ARENA_CHUNK_SIZE, p_size + p_align);
+	Chunk* chunk;
+	if (m_spare && m_spare->size >= size)
+	{
+		chunk = m_spare;
+		m_spare = NULL;
+	}
+	else
+	{
+		if (m_chunks)
+			size = MAX(size, m_chunks->size * 2);
+		chunk = (Chunk*)memalloc(sizeof(Chunk) + size);
+		chunk->size = size;
+	}
+	chunk->next = m_chunks;
+	m_chunks = chunk;
+	ptr = arena_align((uint8_t*)(chunk + 1), p_align);
+	chunk->used = ptr + p_size - (uint8_t*)(chunk + 1);
+	return ptr;
+}
+
+Variant* PyScratchArena::variants(int p_count)
+{
+	Variant* ret = (Variant*)alloc(sizeof(Variant) * MAX(p_count, 1), alignof(Variant));
+	for (int i = 0; i < p_count; ++i)
+	{
+		memnew_placement(&ret[i], Variant);
+	}
+	VariantBlock* block = (VariantBlock*)alloc(sizeof(VariantBlock));
+	block->next = m_variants;
+	block->ptr = ret;
+	block->count = p_count;
+	m_variants = block;
+	return ret;
+}
+
+size_t PyScratchArena::get_capacity() const
+{
+	size_t ret = 0;
+	for (Chunk* chunk = m_chunks; chunk; chunk = chunk->next)
+	{
+		ret += chunk->size;
+	}
+	return ret;
+}
+
+PyScratchArena::Mark PyScratchArena::mark() const
+{
+	Mark ret;
+	ret.chunk = m_chunks;
+	ret.chunkUsed = m_chunks ? m_chunks->used : 0;
+	ret.variants = m_variants;
+	ret.heap = m_heap.size();
+	ret.used = m_used;
+	return ret;
+}
+
+// Destroying a Variant can run script code that opens Scopes of its own, so the blocks
+// are unlinked first and their memory is only given back afterwards.
+void PyScratchArena::rewind(const Mark& p_mark)
+{
+	VariantBlock* blocks = m_variants;
+	m_variants = p_mark.variants;
+	for (VariantBlock* block = blocks; block != p_mark.variants; block = block->next)
+	{
+		for (int i = 0; i < block->count; ++i)
+		{
+			block->ptr[i].~Variant();
+		}
+	}
+
+	for (int i = p_mark.heap; i < m_heap.size(); ++i)
+	{
+		memfree(m_heap[i]);
+	}
+	m_heap.resize(p_mark.heap);
+
+	while (m_chunks != p_mark.chunk)
+	{
+		Chunk* chunk = m_chunks;
+		m_chunks = chunk->next;
+		if (m_spare && m_spare->size >= chunk->size)
+		{
+			memfree(chunk);
+			continue;
+		}
+		if (m_spare)
+			memfree(m_spare);
+		m_spare = chunk;
+	}
+	if (m_chunks)
+		m_chunks->used = p_mark.chunkUsed;
+	m_used = p_mark.used;
+}
+
+void PyScratchArena::reset()
+{
+	VariantBlock* blocks = m_variants;
+	m_variants = NULL;
+	for (VariantBlock* block = blocks; block; block = block->next)
+	{
+		for (int i = 0; i < block->count; ++i)
+		{
+			block->ptr[i].~Variant();
+		}
+	}
+
+	for (int i = 0; i < m_heap.size(); ++i)
+	{
+		memfree(m_heap[i]);
+	}
+	m_heap.clear();
+	m_used = 0;
+
+	if (!m_chunks)
+		return;
+	// Keep only the newest (largest) chunk; the next call of the same size won't allocate.
+	Chunk* chunk = m_chunks->next;
+	while (chunk)
+	{
+		Chunk* next = chunk->next;
+		memfree(chunk);
+		chunk = next;
+	}
+	m_chunks->next = NULL;
+	m_chunks->used = 0;
+}
+
+PyScratchArena::~PyScratchArena()
+{
+	reset();
+	if (m_chunks)
+		memfree(m_chunks);
+	if (m_spare)
+		memfree(m_spare);
+	m_chunks = NULL;
+	m_spare = NULL;
+}
@@ -0,0 +1,88 @@
+#ifndef PY_ARENA_H
+#define PY_ARENA_H
+
+#include "core/variant.h"
+
+// Per-thread bump allocator for temporaries of one bridge call: argument Variants and
+// argument pointer arrays. A Scope marks a bridge entry point and rewinds the arena to
+// where it was when the Scope began, destroying only the Variants made inside it, so
+// nested calls (Python -> Godot -> Python) keep their parents' data alive and a loop of
+// nested calls reuses the same memory. The outermost Scope resets the arena.
+class PyScratchArena
+{
+private:
+	typedef struct Chunk {
+		Chunk* next;
+		size_t size;
+		size_t used;
+	}Chunk;
+
+	// Kept in the arena itself so tracking them costs no heap allocation.
+	typedef struct VariantBlock {
+		VariantBlock* next;
+		Variant* ptr;
+		int count;
+	}VariantBlock;
+
+	typedef struct Mark {
+		Chunk* chunk;
+		size_t chunkUsed;
+		VariantBlock* variants;
+		int heap;
+		size_t used;
+	}Mark;
+
+	static bool enabled;
+
+	Chunk* m_chunks = NULL;
+	// The largest chunk a nested Scope gave back, reused before allocating a new one.
+	Chunk* m_spare = NULL;
+	VariantBlock* m_variants = NULL;
+	Vector<void*> m_heap;
+	int m_depth = 0;
+	size_t m_used = 0;
+	size_t m_highWater = 0;
+
+	Mark mark() const;
+	void rewind(const Mark& p_mark);
+	void reset();
+
+public:
+	class Scope
+	{
+	private:
+		PyScratchArena& m_arena;
+		Mark m_mark;
+
+	public:
+		Scope() : m_arena(PyScratchArena::get()), m_mark(m_arena.mark()) { ++m_arena.m_depth; }
+		// Still counted while rewinding, so a Scope opened by a destructor nests inside this one.
+		~Scope()
+		{
+			if (m_arena.m_depth == 1)
+				m_arena.reset();
+			else
+				m_arena.rewind(m_mark);
+			--m_arena.m_depth;
+		}
+	};
+
+	static PyScratchArena& get();
+	// With the arena off every allocation goes to the heap and is freed at the same point.
+	static void set_enabled(bool p_enabled) { enabled = p_enabled; }
+	static bool is_enabled() { return enabled; }
+
+	void* alloc(size_t p_size, size_t p_align = sizeof(void*));
+	// p_count NIL Variants; the Scope they were made in destroys them.
+	Variant* variants(int p_count);
+	const Variant** pointers(int p_count) { return (const Variant**)alloc(sizeof(Variant*) * MAX(p_count, 1)); }
+
+	size_t get_high_water() const { return m_highWater; }
+	// Starts a new measurement from what is in use now.
+	void reset_high_water() { m_highWater = m_used; }
+	size_t get_capacity() const;
+
+	~PyScratchArena();
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "py_code.h"
+#include "pyscript.h"
+#include "py_names.h"
+
+Error PyCode::compile(const String& p_source, const String& p_mode)
+{
+	int start;
+	if (p_mode == "eval")
+		start = Py_eval_input;
+	else if (p_mode == "exec")
+		start = Py_file_input;
+	else if (p_mode == "single")
+		start = Py_single_input;
+	else
+		ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Mode must be \"eval\", \"exec\" or \"single\".");
+
+	PyObject* code = Py_CompileString(p_source.utf8().get_data(), "<godot>", start);
+	if (!code)
+	{
+		PyErr_Print();
+		return ERR_PARSE_ERROR;
+	}
+
+	if (!m_namespace)
+	{
+		m_namespace = PyDict_New();
+		PyDict_SetItemString(m_namespace, "__builtins__", PyEval_GetBuiltins());
+	}
+	Py_XDECREF(m_code);
+	m_code = code;
+	m_source = p_source;
+	m_mode = p_mode;
+	return OK;
+}
+
+Variant PyCode::run(const Dictionary& p_locals, bool p_writeBack)
+{
+	ERR_FAIL_COND_V_MSG(!m_code, Variant(), "PyCode is not compiled.");
+
+	PyNameCache& names = PyNameCache::get();
+	for (const Variant* key = p_locals.next(NULL); key; key = p_locals.next(key))
+	{
+		ERR_CONTINUE_MSG(key->get_type() != Variant::STRING, "Locals keys must be strings.");
+		PyObject* name = names.to_py(String(*key));
+		PyObject* value = PyScript::gd2py(p_locals.getptr(*key));
+		if (!name || PyDict_SetItem(m_namespace, name, value) != 0)
+			PyErr_Clear();
+		Py_XDECREF(name);
+		if (value != Py_None)
+			Py_XDECREF(value);
+	}
+
+	PyObject* ret = PyEval_EvalCode(m_code, m_namespace, m_namespace);
+	if (!ret)
+	{
+		PyErr_Print();
+		return Variant();
+	}
+	Variant value = PyScript::py2gd(ret);
+	Py_DECREF(ret);
+
+	if (p_writeBack)
+	{
+		// Dictionary is shared, so this updates the caller's copy in place.
+		Dictionary locals = p_locals;
+		for (const Variant* key = locals.next(NULL); key; key = locals.next(key))
+		{
+			if (key->get_type() != Variant::STRING)
+				continue;
+			PyObject* name = names.to_py(String(*key));
+			PyObject* item = name ? PyDict_GetItem(m_namespace, name) : NULL;
+			Py_XDECREF(name);
+			PyErr_Clear();
+			if (item)
+				locals[*key] = PyScript::py2gd(item);
+		}
+	}
+	return value;
+}
+
+String PyCode::get_source() const
+{
+	return m_source;
+}
+
+String PyCode::get_mode() const
+{
+	return m_mode;
+}
+
+Dictionary PyCode::get_namespace() const
+{
+	Dictionary ret;
+	if (!m_namespace)
+		return ret;
+	PyObject *key, *value;
+	Py_ssize_t pos = 0;
+	while (PyDict_Next(m_namespace, &pos, &key, &value))
+	{
+		if (PyUnicode_Check(key) && PyUnicode_CompareWithASCIIString(key, "__builtins__") != 0)
+			ret[String(PyNameCache::get().to_name(key))] = PyScript::py2gd(value);
+	}
+	return ret;
+}
+
+void PyCode::clear_namespace()
+{
+	if (!m_namespace)
+		return;
+	PyDict_Clear(m_namespace);
+	PyDict_SetItemString(m_namespace, "__builtins__", PyEval_GetBuiltins());
+}
+
+void PyCode::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("get_source"), &PyCode::get_source);
+	ClassDB::bind_method(D_METHOD("get_mode"), &PyCode::get_mode);
+	ClassDB::bind_method(D_METHOD("get_namespace"), &PyCode::get_namespace);
+	ClassDB::bind_method(D_METHOD("clear_namespace"), &PyCode::clear_namespace);
+}
+
+PyCode::~PyCode()
+{
+	Py_XDECREF(m_code);
+	Py_XDECREF(m_namespace);
+}
@@ -0,0 +1,39 @@
+#ifndef PY_CODE_H
+#define PY_CODE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/reference.h"
+
+// A compiled Python expression or statement block with its own namespace dict.
+// The namespace lives as long as the PyCode, so eval/exec only write the given
+// locals into it and run the code object, without recompiling or new dicts.
+class PyCode : public Reference
+{
+	GDCLASS(PyCode, Reference);
+
+private:
+	PyObject* m_code = NULL;
+	PyObject* m_namespace = NULL;
+	String m_source;
+	String m_mode;
+
+protected:
+	static void _bind_methods();
+
+public:
+	Error compile(const String& p_source, const String& p_mode);
+	// Runs the code after storing p_locals in the namespace. With p_writeBack the keys of
+	// p_locals are read back afterwards, so exec can update the caller's Dictionary.
+	Variant run(const Dictionary& p_locals, bool p_writeBack);
+
+	String get_source() const;
+	String get_mode() const;
+	Dictionary get_namespace() const;
+	void clear_namespace();
+
+	PyCode() {};
+	~PyCode();
+};
+
+#endif
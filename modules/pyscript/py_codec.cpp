@@ -0,0 +1,599 @@
+#include "py_codec.h"
+#include "pyscript.h"
+#include "py_memo.h"
+#include "core/set.h"
+#include "core/io/marshalls.h"
+
+#define CODEC_FLAG_64 (1 << 16)
+
+#define CODEC_NEED(m_len)                                               \
+	if ((m_len) < 0 || p_len < (m_len))                                 \
+	{                                                                   \
+		PyErr_SetString(PyExc_ValueError, "Truncated variant data."); \
+		return NULL;                                                    \
+	}
+
+static inline int codec_pad(int p_len)
+{
+	return (4 - p_len % 4) % 4;
+}
+
+static bool codec_check_depth(int p_depth)
+{
+	if (p_depth > 0)
+		return true;
+	PyErr_Format(PyExc_ValueError, "Variant nests deeper than %d levels (Python.conversion_max_depth).", PyConvertMemo::get_max_depth());
+	return false;
+}
+
+static PyObject* codec_decode_string(const uint8_t*& p_buf, int& p_len, bool p_nulTerminated)
+{
+	CODEC_NEED(4);
+	int strlen = (int)decode_uint32(p_buf);
+	p_buf += 4;
+	p_len -= 4;
+	int padded = strlen + codec_pad(strlen);
+	CODEC_NEED(padded);
+
+	int size = strlen;
+	if (p_nulTerminated)
+	{
+		while (size > 0 && p_buf[size - 1] == 0)
+			--size;
+	}
+	PyObject* ret = PyUnicode_DecodeUTF8((const char*)p_buf, size, "replace");
+	p_buf += padded;
+	p_len -= padded;
+	return ret;
+}
+
+// p_depth is how many more Arrays/Dictionaries may be opened below this value.
+static PyObject* codec_decode_value(const uint8_t*& p_buf, int& p_len, bool p_tuple, int p_depth)
+{
+	CODEC_NEED(4);
+	uint32_t header = decode_uint32(p_buf);
+	p_buf += 4;
+	p_len -= 4;
+	bool wide = header & CODEC_FLAG_64;
+
+	// Math types map to None like PyScript::gd2py; only their size matters here.
+	int64_t skip = 0;
+	switch (header & 0xFF)
+	{
+	case Variant::NIL:
+		Py_RETURN_NONE;
+	case Variant::BOOL:
+	{
+		CODEC_NEED(4);
+		uint32_t v = decode_uint32(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		return PyBool_FromLong(v);
+	}
+	case Variant::INT:
+	{
+		if (wide)
+		{
+			CODEC_NEED(8);
+			int64_t v = (int64_t)decode_uint64(p_buf);
+			p_buf += 8;
+			p_len -= 8;
+			return PyLong_FromLongLong(v);
+		}
+		CODEC_NEED(4);
+		int32_t v = (int32_t)decode_uint32(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		return PyLong_FromLong(v);
+	}
+	case Variant::REAL:
+	{
+		if (wide)
+		{
+			CODEC_NEED(8);
+			double v = decode_double(p_buf);
+			p_buf += 8;
+			p_len -= 8;
+			return PyFloat_FromDouble(v);
+		}
+		CODEC_NEED(4);
+		float v = decode_float(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		return PyFloat_FromDouble(v);
+	}
+	case Variant::STRING:
+		return codec_decode_string(p_buf, p_len, false);
+	case Variant::VECTOR2:
+		skip = 8;
+		break;
+	case Variant::VECTOR3:
+		skip = 12;
+		break;
+	case Variant::RECT2:
+	case Variant::PLANE:
+	case Variant::QUAT:
+	case Variant::COLOR:
+		skip = 16;
+		break;
+	case Variant::TRANSFORM2D:
+	case Variant::AABB:
+		skip = 24;
+		break;
+	case Variant::BASIS:
+		skip = 36;
+		break;
+	case Variant::TRANSFORM:
+		skip = 48;
+		break;
+	case Variant::_RID:
+		Py_RETURN_NONE;
+	case Variant::NODE_PATH:
+	{
+		CODEC_NEED(4);
+		uint32_t names = decode_uint32(p_buf);
+		int count = 1;
+		if (names & 0x80000000)
+		{
+			CODEC_NEED(12);
+			count = (names & 0x7FFFFFFF) + decode_uint32(p_buf + 4);
+			p_buf += 12;
+			p_len -= 12;
+		}
+		for (int i = 0; i < count; ++i)
+		{
+			PyObject* name = codec_decode_string(p_buf, p_len, false);
+			if (!name)
+				return NULL;
+			Py_DECREF(name);
+		}
+		Py_RETURN_NONE;
+	}
+	case Variant::OBJECT:
+	{
+		if (!wide)
+		{
+			PyErr_SetString(PyExc_ValueError, "Full objects are not supported.");
+			return NULL;
+		}
+		CODEC_NEED(8);
+		ObjectID id = decode_uint64(p_buf);
+		p_buf += 8;
+		p_len -= 8;
+		Object* obj = id ? ObjectDB::get_instance(id) : NULL;
+		if (!obj)
+			Py_RETURN_NONE;
+		Variant v = obj;
+		Reference* ref = Object::cast_to<Reference>(obj);
+		if (ref)
+			v = REF(ref);
+		return PyScript::gd2py_owned(v);
+	}
+	case Variant::DICTIONARY:
+	{
+		if (!codec_check_depth(p_depth))
+			return NULL;
+		CODEC_NEED(4);
+		int count = decode_uint32(p_buf) & 0x7FFFFFFF;
+		p_buf += 4;
+		p_len -= 4;
+		PyObject* ret = PyDict_New();
+		for (int i = 0; i < count; ++i)
+		{
+			PyObject* key = codec_decode_value(p_buf, p_len, true, p_depth - 1);
+			PyObject* value = key ? codec_decode_value(p_buf, p_len, false, p_depth - 1) : NULL;
+			if (!value)
+			{
+				Py_XDECREF(key);
+				Py_DECREF(ret);
+				return NULL;
+			}
+			if (PyDict_SetItem(ret, key, value) != 0)
+			{
+				PyErr_Clear();
+				print_error("PyDict_SetItem failed!");
+			}
+			Py_DECREF(key);
+			Py_DECREF(value);
+		}
+		return ret;
+	}
+	case Variant::ARRAY:
+	{
+		if (!codec_check_depth(p_depth))
+			return NULL;
+		CODEC_NEED(4);
+		int count = decode_uint32(p_buf) & 0x7FFFFFFF;
+		p_buf += 4;
+		p_len -= 4;
+		// Each item takes at least its 4-byte header.
+		CODEC_NEED((int64_t)count * 4);
+		PyObject* ret = p_tuple ? PyTuple_New(count) : PyList_New(count);
+		for (int i = 0; i < count; ++i)
+		{
+			PyObject* item = codec_decode_value(p_buf, p_len, false, p_depth - 1);
+			if (!item)
+			{
+				Py_DECREF(ret);
+				return NULL;
+			}
+			if (p_tuple)
+				PyTuple_SET_ITEM(ret, i, item);
+			else
+				PyList_SET_ITEM(ret, i, item);
+		}
+		return ret;
+	}
+	case Variant::POOL_BYTE_ARRAY:
+	{
+		CODEC_NEED(4);
+		int count = decode_uint32(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		int padded = count + codec_pad(count);
+		CODEC_NEED(padded);
+		PyObject* ret = PyByteArray_FromStringAndSize((const char*)p_buf, count);
+		p_buf += padded;
+		p_len -= padded;
+		return ret;
+	}
+	case Variant::POOL_INT_ARRAY:
+	case Variant::POOL_REAL_ARRAY:
+	{
+		CODEC_NEED(4);
+		int count = decode_uint32(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		CODEC_NEED((int64_t)count * 4);
+		bool real = (header & 0xFF) == Variant::POOL_REAL_ARRAY;
+		PyObject* ret = PyList_New(count);
+		for (int i = 0; i < count; ++i)
+		{
+			PyObject* item = real ? PyFloat_FromDouble(decode_float(p_buf)) : PyLong_FromLong((int32_t)decode_uint32(p_buf));
+			PyList_SET_ITEM(ret, i, item);
+			p_buf += 4;
+		}
+		p_len -= count * 4;
+		return ret;
+	}
+	case Variant::POOL_STRING_ARRAY:
+	{
+		CODEC_NEED(4);
+		int count = decode_uint32(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		CODEC_NEED((int64_t)count * 4);
+		PyObject* ret = PyList_New(count);
+		for (int i = 0; i < count; ++i)
+		{
+			PyObject* item = codec_decode_string(p_buf, p_len, true);
+			if (!item)
+			{
+				Py_DECREF(ret);
+				return NULL;
+			}
+			PyList_SET_ITEM(ret, i, item);
+		}
+		return ret;
+	}
+	case Variant::POOL_VECTOR2_ARRAY:
+	case Variant::POOL_VECTOR3_ARRAY:
+	case Variant::POOL_COLOR_ARRAY:
+	{
+		CODEC_NEED(4);
+		int count = decode_uint32(p_buf);
+		p_buf += 4;
+		p_len -= 4;
+		int type = header & 0xFF;
+		skip = (int64_t)count * (type == Variant::POOL_VECTOR2_ARRAY ? 8 : (type == Variant::POOL_VECTOR3_ARRAY ? 12 : 16));
+	} break;
+	default:
+		PyErr_Format(PyExc_ValueError, "Unknown variant type %d.", (int)(header & 0xFF));
+		return NULL;
+	}
+
+	CODEC_NEED(skip);
+	p_buf += skip;
+	p_len -= skip;
+	Py_RETURN_NONE;
+}
+
+PyObject* codec_decode(const uint8_t* p_buf, int p_len, int p_maxDepth, bool p_tuple)
+{
+	return codec_decode_value(p_buf, p_len, p_tuple, p_maxDepth);
+}
+
+class CodecWriter
+{
+private:
+	Vector<uint8_t>& m_buf;
+
+	Set<PyObject*> m_seen;
+	bool m_tree;
+	int m_depth;
+
+public:
+	int size = 0;
+
+	// Called on entering a list, tuple or dict. Fails when it nests too deep or, for a
+	// tree-only encode, when the container was met before, which means it is shared or
+	// cyclic. Only containers with more than one reference can be met twice.
+	bool enter(PyObject* p_obj)
+	{
+		if (!codec_check_depth(m_depth))
+			return false;
+		if (m_tree && Py_REFCNT(p_obj) > 1)
+		{
+			if (m_seen.has(p_obj))
+			{
+				PyErr_SetString(PyExc_ValueError, "Shared or cyclic container.");
+				return false;
+			}
+			m_seen.insert(p_obj);
+		}
+		--m_depth;
+		return true;
+	}
+
+	void leave() { ++m_depth; }
+
+	uint8_t* reserve(int p_len)
+	{
+		if (size + p_len > m_buf.size())
+			m_buf.resize(MAX(m_buf.size() * 2, size + p_len + 64));
+		uint8_t* ret = m_buf.ptrw() + size;
+		size += p_len;
+		return ret;
+	}
+
+	uint8_t* at(int p_pos) { return m_buf.ptrw() + p_pos; }
+	void put_u32(uint32_t p_value) { encode_uint32(p_value, reserve(4)); }
+	void put_u64(uint64_t p_value) { encode_uint64(p_value, reserve(8)); }
+	void put_double(double p_value) { encode_double(p_value, reserve(8)); }
+
+	void put_bytes(const void* p_data, int p_len)
+	{
+		int pad = codec_pad(p_len);
+		uint8_t* w = reserve(p_len + pad);
+		memcpy(w, p_data, p_len);
+		memset(w + p_len, 0, pad);
+	}
+
+	void put_variant(const Variant& p_value)
+	{
+		int len;
+		encode_variant(p_value, NULL, len);
+		encode_variant(p_value, reserve(len), len);
+	}
+
+	CodecWriter(Vector<uint8_t>& p_buf, int p_maxDepth, bool p_tree) :
+			m_buf(p_buf), m_tree(p_tree), m_depth(p_maxDepth) {}
+};
+
+static bool codec_encode_item(PyObject* p_obj, CodecWriter& p_writer);
+
+static bool codec_encode_value(PyObject* p_obj, CodecWriter& p_writer)
+{
+	if (Py_EnterRecursiveCall(" while encoding a variant"))
+		return false;
+	bool ret = codec_encode_item(p_obj, p_writer);
+	Py_LeaveRecursiveCall();
+	return ret;
+}
+
+// Follows PyScript::py2gd, but gives up on anything py2gd would wrap in a PyScript/PyScriptInstance.
+static bool codec_encode_item(PyObject* p_obj, CodecWriter& p_writer)
+{
+	if (p_obj == Py_None)
+	{
+		p_writer.put_u32(Variant::NIL);
+	}
+	else if (p_obj == Py_True || p_obj == Py_False)
+	{
+		p_writer.put_u32(Variant::BOOL);
+		p_writer.put_u32(p_obj == Py_True);
+	}
+	else if (PyType_Check(p_obj))
+	{
+		PyErr_SetString(PyExc_TypeError, "Classes can't be encoded as variants.");
+		return false;
+	}
+	else if (PyLong_Check(p_obj))
+	{
+		int overflow = 0;
+		long long v = PyLong_AsLongLongAndOverflow(p_obj, &overflow);
+		if (overflow)
+		{
+			PyErr_SetString(PyExc_OverflowError, "int too large for a variant.");
+			return false;
+		}
+		if (v < INT32_MIN || v > INT32_MAX)
+		{
+			p_writer.put_u32(Variant::INT | CODEC_FLAG_64);
+			p_writer.put_u64(v);
+		}
+		else
+		{
+			p_writer.put_u32(Variant::INT);
+			p_writer.put_u32((uint32_t)(int32_t)v);
+		}
+	}
+	else if (PyFloat_Check(p_obj))
+	{
+		p_writer.put_u32(Variant::REAL | CODEC_FLAG_64);
+		p_writer.put_double(PyFloat_AS_DOUBLE(p_obj));
+	}
+	else if (PyBytes_Check(p_obj) || PyByteArray_Check(p_obj))
+	{
+		Py_ssize_t size = PyBytes_Check(p_obj) ? PyBytes_GET_SIZE(p_obj) : PyByteArray_GET_SIZE(p_obj);
+		const char* data = PyBytes_Check(p_obj) ? PyBytes_AS_STRING(p_obj) : PyByteArray_AS_STRING(p_obj);
+		p_writer.put_u32(Variant::POOL_BYTE_ARRAY);
+		p_writer.put_u32(size);
+		p_writer.put_bytes(data, size);
+	}
+	else if (PyUnicode_Check(p_obj))
+	{
+		Py_ssize_t size;
+		const char* str = PyUnicode_AsUTF8AndSize(p_obj, &size);
+		if (!str)
+			return false;
+		p_writer.put_u32(Variant::STRING);
+		p_writer.put_u32(size);
+		p_writer.put_bytes(str, size);
+	}
+	else if (PyTuple_Check(p_obj) || PyList_Check(p_obj))
+	{
+		if (!p_writer.enter(p_obj))
+			return false;
+		Variant pool;
+		if (PyScript::seq2pool(p_obj, pool))
+		{
+			p_writer.put_variant(pool);
+			p_writer.leave();
+			return true;
+		}
+
+		Py_ssize_t size = PySequence_Fast_GET_SIZE(p_obj);
+		PyObject** items = PySequence_Fast_ITEMS(p_obj);
+		p_writer.put_u32(Variant::ARRAY);
+		p_writer.put_u32(size);
+		for (Py_ssize_t i = 0; i < size; ++i)
+		{
+			if (!codec_encode_value(items[i], p_writer))
+				return false;
+		}
+		p_writer.leave();
+	}
+	else if (PyDict_Check(p_obj))
+	{
+		if (!p_writer.enter(p_obj))
+			return false;
+		p_writer.put_u32(Variant::DICTIONARY);
+		int countPos = p_writer.size;
+		p_writer.put_u32(0);
+
+		uint32_t count = 0;
+		PyObject* key, * value;
+		Py_ssize_t pos = 0;
+		while (PyDict_Next(p_obj, &pos, &key, &value))
+		{
+			// py2gd drops entries whose key converts to null.
+			if (key == Py_None)
+				continue;
+			if (!codec_encode_value(key, p_writer) || !codec_encode_value(value, p_writer))
+				return false;
+			++count;
+		}
+		encode_uint32(count, p_writer.at(countPos));
+		p_writer.leave();
+	}
+	else
+	{
+		PyErr_Format(PyExc_TypeError, "'%s' can't be encoded as a variant.", Py_TYPE(p_obj)->tp_name);
+		return false;
+	}
+	return true;
+}
+
+bool codec_encode(PyObject* p_obj, Vector<uint8_t>& r_buf, int p_maxDepth, bool p_tree)
+{
+	CodecWriter writer(r_buf, p_maxDepth, p_tree);
+	bool ret = codec_encode_value(p_obj, writer);
+	r_buf.resize(ret ? writer.size : 0);
+	return ret;
+}
+
+// Container levels left to the codec when gd2py/py2gd call it from the Scope of the
+// container itself.
+static int codec_depth_budget()
+{
+	return PyConvertMemo::get_max_depth() - PyConvertMemo::get().get_depth() + 1;
+}
+
+static const void* codec_container_id(const Variant& p_value)
+{
+	if (p_value.get_type() == Variant::ARRAY)
+		return p_value.operator Array().id();
+	if (p_value.get_type() == Variant::DICTIONARY)
+		return p_value.operator Dictionary().id();
+	return NULL;
+}
+
+// False when an Array or Dictionary is met twice below p_value (shared or cyclic) or the
+// containers nest deeper than p_depth. encode_variant would copy the first and never
+// return from a cycle.
+static bool codec_is_tree(const Variant& p_value, Set<const void*>& p_seen, int p_depth)
+{
+	const void* id = codec_container_id(p_value);
+	if (!id)
+		return true;
+	if (p_depth <= 0 || p_seen.has(id))
+		return false;
+	p_seen.insert(id);
+	if (p_value.get_type() == Variant::ARRAY)
+	{
+		const Array a = p_value;
+		for (int i = 0; i < a.size(); ++i)
+		{
+			if (!codec_is_tree(a[i], p_seen, p_depth - 1))
+				return false;
+		}
+		return true;
+	}
+	const Dictionary d = p_value;
+	for (const Variant* key = d.next(NULL); key; key = d.next(key))
+	{
+		if (!codec_is_tree(*key, p_seen, p_depth - 1) || !codec_is_tree(d[*key], p_seen, p_depth - 1))
+			return false;
+	}
+	return true;
+}
+
+PyObject* codec_gd2py(const Variant& p_source, bool p_tuple)
+{
+	int depth = codec_depth_budget();
+	Set<const void*> seen;
+	if (!codec_is_tree(p_source, seen, depth))
+		return NULL;
+	int len;
+	if (encode_variant(p_source, NULL, len) != OK)
+		return NULL;
+	Vector<uint8_t> buf;
+	buf.resize(len);
+	encode_variant(p_source, buf.ptrw(), len);
+	PyObject* ret = codec_decode(buf.ptr(), len, depth, p_tuple);
+	if (!ret)
+		PyErr_Clear();
+	return ret;
+}
+
+bool codec_py2gd(PyObject* p_source, Variant& r_ret)
+{
+	Vector<uint8_t> buf;
+	if (!codec_encode(p_source, buf, codec_depth_budget(), true))
+	{
+		PyErr_Clear();
+		return false;
+	}
+	return decode_variant(r_ret, buf.ptr(), buf.size(), NULL, false) == OK;
+}
+
+PyObject* codec_py_encode_variant(PyObject* p_module, PyObject* p_arg)
+{
+	Vector<uint8_t> buf;
+	if (!codec_encode(p_arg, buf, PyConvertMemo::get_max_depth()))
+		return NULL;
+	return PyBytes_FromStringAndSize((const char*)buf.ptr(), buf.size());
+}
+
+PyObject* codec_py_decode_variant(PyObject* p_module, PyObject* p_arg)
+{
+	Py_buffer view;
+	if (PyObject_GetBuffer(p_arg, &view, PyBUF_SIMPLE) != 0)
+		return NULL;
+	PyObject* ret = view.len > INT32_MAX ? NULL : codec_decode((const uint8_t*)view.buf, (int)view.len, PyConvertMemo::get_max_depth());
+	if (!ret && !PyErr_Occurred())
+		PyErr_SetString(PyExc_ValueError, "Buffer too large.");
+	PyBuffer_Release(&view);
+	return ret;
+}
@@ -0,0 +1,32 @@
+#ifndef PY_CODEC_H
+#define PY_CODEC_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/variant.h"
+#include "core/vector.h"
+
+// Bulk conversion through Godot's encode_variant format (the var2bytes layout).
+// Each side walks its tree once in a flat buffer instead of converting node by node
+// through temporary keys()/values() arrays and String re-encoding.
+
+// Python objects from encode_variant bytes, with the same mapping as PyScript::gd2py.
+// Returns NULL with a Python error set on malformed data or containers nested deeper
+// than p_maxDepth.
+PyObject* codec_decode(const uint8_t* p_buf, int p_len, int p_maxDepth, bool p_tuple = false);
+// encode_variant bytes for a tree of None/bool/int/float/str/bytes/list/tuple/dict.
+// Returns false with a Python error set when another object type is found or containers
+// nest deeper than p_maxDepth. With p_tree, a container met twice fails it too.
+bool codec_encode(PyObject* p_obj, Vector<uint8_t>& r_buf, int p_maxDepth, bool p_tree = false);
+
+// The bulk paths of gd2py/py2gd. They give up (NULL/false, no error set) on a source with
+// shared or cyclic containers, which only the memoized converters keep as they are, and
+// on one that nests past conversion_max_depth, which the memoized converters report.
+PyObject* codec_gd2py(const Variant& p_source, bool p_tuple = false);
+bool codec_py2gd(PyObject* p_source, Variant& r_ret);
+
+// godot.encode_variant(obj) / godot.decode_variant(buffer)
+PyObject* codec_py_encode_variant(PyObject* p_module, PyObject* p_arg);
+PyObject* codec_py_decode_variant(PyObject* p_module, PyObject* p_arg);
+
+#endif
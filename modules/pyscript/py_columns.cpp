@@ -0,0 +1,327 @@
+#include "py_columns.h"
+#include "core/math/math_defs.h"
+#include "core/pool_vector.h"
+#include "core/vector.h"
+#include "pyscript.h"
+
+// Cells looked at per column when inferring its type.
+static const int COLUMN_INFER_ROWS = 16;
+
+typedef struct Column {
+	Variant key;
+	// Dict rows: the key of the column, a new reference. Sequence rows: the position.
+	PyObject* pyKey = NULL;
+	int index = -1;
+	Variant::Type type = Variant::NIL;
+	bool coerce = false;
+}Column;
+
+// Borrowed cell of one row, or NULL when the row doesn't have the column.
+static inline PyObject* column_cell(PyObject* p_row, const Column& p_column)
+{
+	if (p_column.pyKey)
+		return PyDict_GetItem(p_row, p_column.pyKey);
+	if (p_column.index >= 0 && p_column.index < PySequence_Fast_GET_SIZE(p_row))
+		return PySequence_Fast_GET_ITEM(p_row, p_column.index);
+	return NULL;
+}
+
+static Variant::Type column_schema_type(int p_type)
+{
+	switch (p_type)
+	{
+	case Variant::BOOL:
+	case Variant::POOL_BYTE_ARRAY:
+		return Variant::BOOL;
+	case Variant::INT:
+	case Variant::POOL_INT_ARRAY:
+		return Variant::INT;
+	case Variant::REAL:
+	case Variant::POOL_REAL_ARRAY:
+		return Variant::REAL;
+	case Variant::STRING:
+	case Variant::POOL_STRING_ARRAY:
+		return Variant::STRING;
+	default:
+		return Variant::NIL;
+	}
+}
+
+static Variant::Type column_infer(PyObject** p_rows, Py_ssize_t p_count, const Column& p_column)
+{
+	bool bools = true;
+	bool ints = true;
+	bool reals = true;
+	bool strs = true;
+	int seen = 0;
+	for (Py_ssize_t i = 0; i < p_count && seen < COLUMN_INFER_ROWS; ++i)
+	{
+		PyObject* cell = column_cell(p_rows[i], p_column);
+		if (!cell || cell == Py_None)
+			continue;
+		++seen;
+		bool isInt = PyLong_Check(cell);
+		bools = bools && PyBool_Check(cell);
+		ints = ints && isInt;
+		reals = reals && (isInt || PyFloat_Check(cell));
+		strs = strs && PyUnicode_Check(cell);
+	}
+	if (seen == 0)
+		return Variant::NIL;
+	if (bools)
+		return Variant::BOOL;
+	if (ints)
+		return Variant::INT;
+	if (reals)
+		return Variant::REAL;
+	if (strs)
+		return Variant::STRING;
+	return Variant::NIL;
+}
+
+static bool cell_int(PyObject* p_cell, bool p_coerce, int& r_ret)
+{
+	r_ret = 0;
+	if (!p_cell || p_cell == Py_None)
+		return true;
+	PyObject* number = NULL;
+	if (!PyLong_Check(p_cell))
+	{
+		if (!p_coerce)
+			return false;
+		number = PyNumber_Long(p_cell);
+		if (!number)
+		{
+			PyErr_Clear();
+			return true;
+		}
+	}
+	int overflow = 0;
+	long long value = PyLong_AsLongLongAndOverflow(number ? number : p_cell, &overflow);
+	Py_XDECREF(number);
+	// PoolIntArray holds 32-bit ints.
+	if (overflow || value < INT32_MIN || value > INT32_MAX)
+	{
+		if (!p_coerce)
+			return false;
+		value = overflow < 0 || value < INT32_MIN ? INT32_MIN : INT32_MAX;
+	}
+	r_ret = (int)value;
+	return true;
+}
+
+static bool cell_real(PyObject* p_cell, bool p_coerce, real_t& r_ret)
+{
+	r_ret = Math_NAN;
+	if (!p_cell || p_cell == Py_None)
+		return true;
+	if (!p_coerce && !PyFloat_Check(p_cell) && !PyLong_Check(p_cell))
+		return false;
+	double value = PyFloat_AsDouble(p_cell);
+	if (value == -1.0 && PyErr_Occurred())
+	{
+		PyErr_Clear();
+		return true;
+	}
+	r_ret = value;
+	return true;
+}
+
+static bool cell_string(PyObject* p_cell, bool p_coerce, String& r_ret)
+{
+	r_ret = String();
+	if (!p_cell || p_cell == Py_None)
+		return true;
+	PyObject* str = NULL;
+	if (!PyUnicode_Check(p_cell))
+	{
+		if (!p_coerce)
+			return false;
+		str = PyObject_Str(p_cell);
+		if (!str)
+		{
+			PyErr_Clear();
+			return true;
+		}
+	}
+	Py_ssize_t size;
+	const char* utf8 = PyUnicode_AsUTF8AndSize(str ? str : p_cell, &size);
+	if (utf8)
+		r_ret.parse_utf8(utf8, size);
+	else
+		PyErr_Clear();
+	Py_XDECREF(str);
+	return true;
+}
+
+static bool cell_bool(PyObject* p_cell, bool p_coerce, uint8_t& r_ret)
+{
+	r_ret = 0;
+	if (!p_cell || p_cell == Py_None)
+		return true;
+	if (!p_coerce && !PyBool_Check(p_cell))
+		return false;
+	int value = PyObject_IsTrue(p_cell);
+	if (value < 0)
+		PyErr_Clear();
+	r_ret = value > 0;
+	return true;
+}
+
+// Fills one column of p_column.type. Returns false when a cell doesn't fit and the column
+// isn't coerced.
+static bool column_fill(PyObject** p_rows, Py_ssize_t p_count, const Column& p_column, Variant& r_ret)
+{
+	switch (p_column.type)
+	{
+	case Variant::BOOL:
+	{
+		PoolByteArray data;
+		data.resize(p_count);
+		PoolByteArray::Write w = data.write();
+		for (Py_ssize_t i = 0; i < p_count; ++i)
+		{
+			if (!cell_bool(column_cell(p_rows[i], p_column), p_column.coerce, w[i]))
+				return false;
+		}
+		w.release();
+		r_ret = data;
+	} break;
+	case Variant::INT:
+	{
+		PoolIntArray data;
+		data.resize(p_count);
+		PoolIntArray::Write w = data.write();
+		for (Py_ssize_t i = 0; i < p_count; ++i)
+		{
+			if (!cell_int(column_cell(p_rows[i], p_column), p_column.coerce, w[i]))
+				return false;
+		}
+		w.release();
+		r_ret = data;
+	} break;
+	case Variant::REAL:
+	{
+		PoolRealArray data;
+		data.resize(p_count);
+		PoolRealArray::Write w = data.write();
+		for (Py_ssize_t i = 0; i < p_count; ++i)
+		{
+			if (!cell_real(column_cell(p_rows[i], p_column), p_column.coerce, w[i]))
+				return false;
+		}
+		w.release();
+		r_ret = data;
+	} break;
+	case Variant::STRING:
+	{
+		PoolStringArray data;
+		data.resize(p_count);
+		PoolStringArray::Write w = data.write();
+		for (Py_ssize_t i = 0; i < p_count; ++i)
+		{
+			if (!cell_string(column_cell(p_rows[i], p_column), p_column.coerce, w[i]))
+				return false;
+		}
+		w.release();
+		r_ret = data;
+	} break;
+	default:
+	{
+		Array data;
+		data.resize(p_count);
+		for (Py_ssize_t i = 0; i < p_count; ++i)
+		{
+			PyObject* cell = column_cell(p_rows[i], p_column);
+			if (cell)
+				data[i] = PyScript::py2gd(cell);
+		}
+		r_ret = data;
+	} break;
+	}
+	return true;
+}
+
+bool columns_from_records(PyObject* p_records, const Dictionary& p_schema, Dictionary& r_ret)
+{
+	PyObject* fast = PySequence_Fast(p_records, "to_columns() needs a sequence of records.");
+	if (!fast)
+		return false;
+
+	Py_ssize_t count = PySequence_Fast_GET_SIZE(fast);
+	PyObject** rows = PySequence_Fast_ITEMS(fast);
+	bool dictRows = count > 0 && PyDict_Check(rows[0]);
+	for (Py_ssize_t i = 0; i < count; ++i)
+	{
+		if (dictRows ? !PyDict_Check(rows[i]) : !(PyTuple_Check(rows[i]) || PyList_Check(rows[i])))
+		{
+			PyErr_SetString(PyExc_TypeError, "to_columns() needs records that are all dicts or all tuples/lists.");
+			Py_DECREF(fast);
+			return false;
+		}
+	}
+
+	Vector<Column> columns;
+	if (!p_schema.empty())
+	{
+		int index = 0;
+		for (const Variant* key = p_schema.next(NULL); key; key = p_schema.next(key), ++index)
+		{
+			Column column;
+			column.key = *key;
+			column.type = column_schema_type(*p_schema.getptr(*key));
+			column.coerce = true;
+			if (dictRows)
+			{
+				column.pyKey = PyScript::gd2py_owned(*key, true);
+			}
+			else
+			{
+				column.index = key->get_type() == Variant::INT ? (int)*key : index;
+			}
+			columns.push_back(column);
+		}
+	}
+	else if (dictRows)
+	{
+		Py_ssize_t pos = 0;
+		PyObject* key;
+		PyObject* value;
+		while (PyDict_Next(rows[0], &pos, &key, &value))
+		{
+			Column column;
+			column.key = PyScript::py2gd(key);
+			Py_INCREF(key);
+			column.pyKey = key;
+			column.type = column_infer(rows, count, column);
+			columns.push_back(column);
+		}
+	}
+	else if (count > 0)
+	{
+		int width = PySequence_Fast_GET_SIZE(rows[0]);
+		for (int i = 0; i < width; ++i)
+		{
+			Column column;
+			column.key = i;
+			column.index = i;
+			column.type = column_infer(rows, count, column);
+			columns.push_back(column);
+		}
+	}
+
+	for (int i = 0; i < columns.size(); ++i)
+	{
+		Column& column = columns.write[i];
+		Variant data;
+		if (!column_fill(rows, count, column, data))
+		{
+			column.type = Variant::NIL;
+			column_fill(rows, count, column, data);
+		}
+		r_ret[column.key] = data;
+		Py_XDECREF(column.pyKey);
+	}
+	Py_DECREF(fast);
+	return true;
+}
@@ -0,0 +1,21 @@
+#ifndef PY_COLUMNS_H
+#define PY_COLUMNS_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/dictionary.h"
+
+// Converts a list of records (tuples, lists or dicts, e.g. csv rows or SQL cursor results)
+// into one Pool array per column, so column names aren't repeated per row and cells aren't
+// boxed in Variants. Column types come from p_schema (column -> Variant::Type) or are
+// inferred from the first non-None cells of each column:
+//   all bool -> PoolByteArray, all int -> PoolIntArray, int/float -> PoolRealArray,
+//   all str -> PoolStringArray, anything else -> Array.
+// An inferred column that meets a cell of another type later falls back to Array; with a
+// schema, cells are coerced instead. None becomes 0, NAN or "" in a typed column.
+// Dict columns are keyed like the rows; tuple columns by position unless the schema
+// names them in order.
+// Returns false with a Python error set when p_records isn't a sequence of records.
+bool columns_from_records(PyObject* p_records, const Dictionary& p_schema, Dictionary& r_ret);
+
+#endif
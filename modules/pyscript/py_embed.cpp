@@ -0,0 +1,33 @@
+#include "py_embed.h"
+#include "core/ustring.h"
+
+PyObject* embedded_module(const PyEmbeddedModule& p_module)
+{
+	// sys.modules holds the reference, so a module deleted from it is simply built again.
+	PyObject* mod = PyDict_GetItemString(PyImport_GetModuleDict(), p_module.name);
+	if (mod)
+		return mod;
+
+	String file = String(p_module.name) + ".py";
+	PyObject* code = Py_CompileString(p_module.source, file.utf8().get_data(), Py_file_input);
+	if (!code)
+		return NULL;
+	mod = PyImport_ExecCodeModule(p_module.name, code);
+	Py_DECREF(code);
+	if (!mod)
+		return NULL;
+	// Returned as a new reference; the one in sys.modules is what keeps it.
+	Py_DECREF(mod);
+	if (p_module.methods && PyModule_AddFunctions(mod, p_module.methods) != 0)
+		return NULL;
+	return mod;
+}
+
+PyObject* embedded_call(const PyEmbeddedModule& p_module, const char* p_function, PyObject* p_arg)
+{
+	PyObject* mod = embedded_module(p_module);
+	PyObject* ret = mod ? PyObject_CallMethod(mod, p_function, p_arg ? "O" : NULL, p_arg) : NULL;
+	if (!ret)
+		PyErr_Print();
+	return ret;
+}
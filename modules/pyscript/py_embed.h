@@ -0,0 +1,21 @@
+#ifndef PY_EMBED_H
+#define PY_EMBED_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// A Python module whose source is compiled into the module (export, import profiling,
+// memory tools). It is compiled and run on first use and kept in sys.modules under name.
+// methods, if set, is a NULL-terminated table of C functions added to it.
+typedef struct PyEmbeddedModule {
+	const char* name;
+	const char* source;
+	PyMethodDef* methods;
+}PyEmbeddedModule;
+
+// Borrowed reference, or NULL with the error set.
+PyObject* embedded_module(const PyEmbeddedModule& p_module);
+// Calls p_function of the module with p_arg, if any. Prints the error and returns NULL on failure.
+PyObject* embedded_call(const PyEmbeddedModule& p_module, const char* p_function, PyObject* p_arg = NULL);
+
+#endif
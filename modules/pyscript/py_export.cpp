@@ -0,0 +1,237 @@
+#ifdef TOOLS_ENABLED
+
+#include "py_export.h"
+#include "py_embed.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "editor/editor_settings.h"
+
+#define BUNDLE_NAME "pyscript_bundle.zip"
+
+// Runs in the editor's interpreter. build() byte-compiles everything importable;
+// shake() follows the import graph from the set_path/run_file literals found in the
+// project's scripts and scenes plus an allowlist, and only packs what it reaches.
+static const char* EXPORT_SCRIPT = R"(import modulefinder, os, py_compile, re, sys, sysconfig, tempfile, zipfile
+
+SKIP = {"__pycache__", "site-packages", "test", "tests", "idlelib", "turtledemo", "ensurepip", "venv", ".import", ".git"}
+SOURCES = (".gd", ".tscn", ".tres")
+SET_PATH = re.compile(r"""set_path\(\s*["']([\w.]+)["']""")
+RUN_FILE = re.compile(r"""run_file\(\s*["'](res://[^"']+)["']""")
+# Imported while the interpreter starts or by zipimport itself. The bundle only goes on
+# sys.path after Py_Initialize, so these still load from the loose stdlib; they are roots
+# here so the modules they pull in later come from the bundle.
+BASE = ["encodings", "site", "codecs", "io", "abc", "os", "stat", "_collections_abc", "_sitebuiltins", "genericpath", "posixpath", "ntpath"]
+
+def _keep(path):
+    return os.path.basename(path) not in SKIP
+
+def _roots():
+    return [p for p in (sysconfig.get_paths()["stdlib"], sysconfig.get_paths()["purelib"]) if os.path.isdir(p)]
+
+# Project sources that went into the last bundle; only these are left out of the PCK,
+# so files that weren't packed (e.g. run_file scripts) still load from res://.
+packed_sources = []
+
+def _project_sources(project_dir, names):
+    sources = (os.path.join(project_dir, name[:-1]) for name in names if name.endswith(".pyc"))
+    return [src for src in sources if os.path.isfile(src)]
+
+# writepy on a directory that isn't a package only adds its top-level modules, so the
+# packages directly below each root are added one by one.
+def _writepy(zf, root):
+    # writepy also filters the root itself, and the purelib root is site-packages.
+    zf.writepy(root, filterfunc=lambda path: path == root or _keep(path))
+    for name in sorted(os.listdir(root)):
+        path = os.path.join(root, name)
+        if _keep(path) and os.path.isfile(os.path.join(path, "__init__.py")):
+            zf.writepy(path, filterfunc=_keep)
+
+def build(out, project_dir, optimize):
+    global packed_sources
+    with zipfile.PyZipFile(out, "w", zipfile.ZIP_DEFLATED, optimize=optimize) as zf:
+        for root in [project_dir] + _roots():
+            if os.path.isdir(root):
+                _writepy(zf, root)
+            if root == project_dir:
+                packed_sources = _project_sources(project_dir, zf.namelist())
+    return os.path.getsize(out)
+
+def _entry_points(project_dir):
+    modules, scripts = set(), set()
+    for root, dirs, files in os.walk(project_dir):
+        dirs[:] = [d for d in dirs if _keep(d)]
+        for name in files:
+            if not name.endswith(SOURCES):
+                continue
+            try:
+                with open(os.path.join(root, name), encoding="utf-8", errors="ignore") as f:
+                    text = f.read()
+            except OSError:
+                continue
+            modules.update(SET_PATH.findall(text))
+            for path in RUN_FILE.findall(text):
+                scripts.add(os.path.join(project_dir, path[len("res://"):]))
+    return sorted(modules), sorted(scripts)
+
+def _tree_size(roots):
+    total = 0
+    for top in roots:
+        for root, dirs, files in os.walk(top):
+            dirs[:] = [d for d in dirs if _keep(d)]
+            total += sum(os.path.getsize(os.path.join(root, f)) for f in files if f.endswith(".py"))
+    return total
+
+def shake(out, project_dir, optimize, allowlist, report):
+    global packed_sources
+    packed_sources = []
+    modules, scripts = _entry_points(project_dir)
+    finder = modulefinder.ModuleFinder([project_dir] + sys.path)
+    missing = []
+    for name in BASE + list(allowlist) + modules:
+        try:
+            finder.import_hook(name)
+        except ImportError:
+            missing.append(name)
+    for path in scripts:
+        try:
+            finder.run_script(path)
+        except (OSError, SyntaxError):
+            missing.append(path)
+
+    packed, binary, used = 0, [], 0
+    with tempfile.TemporaryDirectory() as tmp, zipfile.ZipFile(out, "w", zipfile.ZIP_DEFLATED) as zf:
+        for name, mod in sorted(finder.modules.items()):
+            src = mod.__file__
+            # __main__ is a run_file script; it isn't packed and stays in the PCK.
+            if not src or name == "__main__":
+                continue
+            if not src.endswith(".py"):
+                binary.append(name)
+                continue
+            arc = name.replace(".", "/") + ("/__init__.pyc" if mod.__path__ else ".pyc")
+            pyc = py_compile.compile(src, os.path.join(tmp, "m.pyc"), arc[:-1], doraise=False, optimize=optimize)
+            if pyc:
+                zf.write(pyc, arc)
+                packed += 1
+                used += os.path.getsize(src)
+                if os.path.abspath(src).startswith(os.path.abspath(project_dir)):
+                    packed_sources.append(src)
+
+    total = _tree_size([project_dir] + _roots())
+    with open(report, "w", encoding="utf-8") as f:
+        f.write("Python export report\n")
+        f.write("set_path roots: %s\n" % ", ".join(modules))
+        f.write("run_file roots (kept in the PCK): %s\n" % ", ".join(scripts))
+        f.write("allowlist: %s\n" % ", ".join(allowlist))
+        f.write("modules packed: %d\n" % packed)
+        f.write("source bytes: %d of %d, %d saved\n" % (used, total, total - used))
+        f.write("bundle bytes: %d\n" % os.path.getsize(out))
+        f.write("binary modules to ship as files: %s\n" % ", ".join(binary))
+        f.write("not found: %s\n" % ", ".join(missing + sorted(finder.badmodules)))
+    return os.path.getsize(out), total - used, len(modules) + len(scripts)
+)";
+
+static const PyEmbeddedModule EXPORT_MODULE = { "_pyscript_export", EXPORT_SCRIPT, NULL };
+
+void PyExportPlugin::_export_begin(const Set<String>& p_features, bool p_debug, const String& p_path, int p_flags)
+{
+	m_bundled = false;
+	if (!GLOBAL_GET("python/export/bundle"))
+		return;
+
+	PyObject* mod = embedded_module(EXPORT_MODULE);
+	if (!mod)
+	{
+		PyErr_Print();
+		ERR_FAIL_MSG("Can't load the Python export script.");
+	}
+
+	String out = EditorSettings::get_singleton()->get_cache_dir().plus_file(BUNDLE_NAME);
+	String projectDir = ProjectSettings::get_singleton()->globalize_path("res://");
+	int optimize = GLOBAL_GET("python/export/optimize");
+	uint64_t start = OS::get_singleton()->get_ticks_msec();
+	PyObject* ret;
+	if (GLOBAL_GET("python/export/tree_shake"))
+	{
+		PoolStringArray allowlist = GLOBAL_GET("python/export/allowlist");
+		PyObject* allow = PyList_New(allowlist.size());
+		for (int i = 0; i < allowlist.size(); ++i)
+		{
+			PyList_SET_ITEM(allow, i, PyUnicode_FromString(allowlist[i].utf8().get_data()));
+		}
+		String report = p_path.get_base_dir().plus_file("pyscript_export_report.txt");
+		ret = PyObject_CallMethod(mod, "shake", "ssiOs", out.utf8().get_data(), projectDir.utf8().get_data(), optimize, allow, report.utf8().get_data());
+		Py_DECREF(allow);
+		if (ret && PyTuple_Check(ret) && PyTuple_GET_SIZE(ret) == 3)
+		{
+			print_line(vformat("Python bundle: %d bytes, %d source bytes saved, %d roots in %d ms. See %s.",
+					(int64_t)PyLong_AsLongLong(PyTuple_GET_ITEM(ret, 0)), (int64_t)PyLong_AsLongLong(PyTuple_GET_ITEM(ret, 1)),
+					(int64_t)PyLong_AsLongLong(PyTuple_GET_ITEM(ret, 2)), (int64_t)(OS::get_singleton()->get_ticks_msec() - start), report));
+		}
+	}
+	else
+	{
+		ret = PyObject_CallMethod(mod, "build", "ssi", out.utf8().get_data(), projectDir.utf8().get_data(), optimize);
+		if (ret)
+			print_line(vformat("Python bundle: %d bytes in %d ms.", (int64_t)PyLong_AsLongLong(ret), (int64_t)(OS::get_singleton()->get_ticks_msec() - start)));
+	}
+	if (!ret)
+	{
+		PyErr_Print();
+		ERR_FAIL_MSG("Building the Python bundle failed.");
+	}
+	Py_DECREF(ret);
+
+	m_packed.clear();
+	PyObject* packed = PyObject_GetAttrString(mod, "packed_sources");
+	if (packed && PyList_Check(packed))
+	{
+		for (Py_ssize_t i = 0; i < PyList_GET_SIZE(packed); ++i)
+		{
+			String src;
+			src.parse_utf8(PyUnicode_AsUTF8(PyList_GET_ITEM(packed, i)));
+			m_packed.insert(ProjectSettings::get_singleton()->localize_path(src.replace("\\", "/")));
+		}
+	}
+	Py_XDECREF(packed);
+	PyErr_Clear();
+
+	add_shared_object(out, Vector<String>());
+	m_bundled = true;
+}
+
+// Only sources that are in the bundle are left out; the rest, e.g. run_file scripts,
+// still have to load from res://.
+void PyExportPlugin::_export_file(const String& p_path, const String& p_type, const Set<String>& p_features)
+{
+	if (!m_bundled)
+		return;
+	if (m_packed.has(p_path) || (p_path.ends_with(".pyc") && p_path.find("/__pycache__/") != -1))
+		skip();
+}
+
+void PyExportPlugin::_export_end()
+{
+	m_bundled = false;
+	m_packed.clear();
+}
+
+void PyExportPlugin::register_settings()
+{
+	GLOBAL_DEF("python/export/bundle", true);
+	GLOBAL_DEF("python/export/optimize", 0);
+	GLOBAL_DEF("python/export/tree_shake", true);
+	GLOBAL_DEF("python/export/allowlist", PoolStringArray());
+	ProjectSettings::get_singleton()->set_custom_property_info("python/export/optimize", PropertyInfo(Variant::INT, "python/export/optimize", PROPERTY_HINT_RANGE, "0,2"));
+}
+
+void PyExportPlugin::editor_init()
+{
+	Ref<PyExportPlugin> plugin;
+	plugin.instance();
+	EditorExport::get_singleton()->add_export_plugin(plugin);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef PY_EXPORT_H
+#define PY_EXPORT_H
+
+#ifdef TOOLS_ENABLED
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "editor/editor_export.h"
+
+// Packs the project's Python code, the stdlib and site-packages into one zip of
+// byte-compiled modules and ships it next to the exported binary as pyscript_bundle.zip.
+// py_init puts that zip first on sys.path, so imports go through zipimport instead of
+// stat-ing and compiling loose files. The .py files themselves are left out of the PCK.
+class PyExportPlugin : public EditorExportPlugin
+{
+	GDCLASS(PyExportPlugin, EditorExportPlugin);
+
+private:
+	bool m_bundled = false;
+	// res:// paths of the project sources packed into the bundle.
+	Set<String> m_packed;
+
+protected:
+	virtual void _export_begin(const Set<String>& p_features, bool p_debug, const String& p_path, int p_flags);
+	virtual void _export_file(const String& p_path, const String& p_type, const Set<String>& p_features);
+	virtual void _export_end();
+
+public:
+	static void register_settings();
+	static void editor_init();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,373 @@
+#include "py_file_io.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+
+// _io._RawIOBase does not export its instance struct, so our fields live after its basicsize.
+typedef struct FileIOData {
+	FileAccess* file;
+	bool readable;
+	bool writable;
+	// Calls using file with the GIL released. Only changed with the GIL held.
+	int busy;
+}FileIOData;
+
+static PyObject* file_io_type = NULL;
+static PyObject* raw_io_base = NULL;
+static Py_ssize_t file_io_offset = 0;
+
+static inline FileIOData* file_io_data(PyObject* p_self)
+{
+	return (FileIOData*)((char*)p_self + file_io_offset);
+}
+
+static FileAccess* file_io_check(PyObject* p_self)
+{
+	FileAccess* file = file_io_data(p_self)->file;
+	if (!file)
+		PyErr_SetString(PyExc_ValueError, "I/O operation on closed file.");
+	return file;
+}
+
+// Waits, lending the GIL, until no call uses the file, so it can be deleted. Returns
+// with the GIL held and busy at 0, so no new call can start before the caller is done.
+static void file_io_wait_idle(FileIOData* p_data)
+{
+	while (p_data->busy > 0)
+	{
+		Py_BEGIN_ALLOW_THREADS
+		OS::get_singleton()->delay_usec(1000);
+		Py_END_ALLOW_THREADS
+	}
+}
+
+static bool file_io_parse_mode(const char* p_mode, int& r_flags, bool& r_readable, bool& r_writable)
+{
+	bool plus = strchr(p_mode, '+') != NULL;
+	if (strchr(p_mode, 'r'))
+	{
+		r_flags = plus ? FileAccess::READ_WRITE : FileAccess::READ;
+		r_readable = true;
+		r_writable = plus;
+		return true;
+	}
+	if (strchr(p_mode, 'w'))
+	{
+		r_flags = plus ? FileAccess::WRITE_READ : FileAccess::WRITE;
+		r_readable = plus;
+		r_writable = true;
+		return true;
+	}
+	PyErr_Format(PyExc_ValueError, "invalid mode: '%s'", p_mode);
+	return false;
+}
+
+static int file_io_init(PyObject* p_self, PyObject* p_args, PyObject* p_kwargs)
+{
+	static const char* kwlist[] = { "path", "mode", NULL };
+	const char* path = NULL;
+	const char* mode = "r";
+	if (!PyArg_ParseTupleAndKeywords(p_args, p_kwargs, "s|s:FileAccessIO", (char**)kwlist, &path, &mode))
+		return -1;
+
+	int flags;
+	FileIOData* data = file_io_data(p_self);
+	if (!file_io_parse_mode(mode, flags, data->readable, data->writable))
+		return -1;
+
+	file_io_wait_idle(data);
+	if (data->file)
+	{
+		memdelete(data->file);
+		data->file = NULL;
+	}
+
+	String gdPath;
+	gdPath.parse_utf8(path);
+	Error err;
+	data->file = FileAccess::open(gdPath, flags, &err);
+	if (!data->file)
+	{
+		PyErr_Format(PyExc_FileNotFoundError, "Can't open '%s' (error %d).", path, (int)err);
+		return -1;
+	}
+
+	PyObject* name = PyUnicode_FromString(path);
+	if (!name || PyObject_SetAttrString(p_self, "name", name) != 0)
+		PyErr_Clear();
+	Py_XDECREF(name);
+	return 0;
+}
+
+static PyObject* file_io_readinto(PyObject* p_self, PyObject* p_arg)
+{
+	FileAccess* file = file_io_check(p_self);
+	if (!file)
+		return NULL;
+	if (!file_io_data(p_self)->readable)
+	{
+		PyErr_SetString(PyExc_OSError, "File not open for reading.");
+		return NULL;
+	}
+
+	Py_buffer view;
+	if (PyObject_GetBuffer(p_arg, &view, PyBUF_WRITABLE) != 0)
+		return NULL;
+
+	int len = view.len > INT32_MAX ? INT32_MAX : (int)view.len;
+	int ret;
+	FileIOData* data = file_io_data(p_self);
+	++data->busy;
+	Py_BEGIN_ALLOW_THREADS
+	ret = file->get_buffer((uint8_t*)view.buf, len);
+	Py_END_ALLOW_THREADS
+	--data->busy;
+	PyBuffer_Release(&view);
+	return PyLong_FromLong(ret);
+}
+
+static PyObject* file_io_readall(PyObject* p_self, PyObject* p_unused)
+{
+	FileAccess* file = file_io_check(p_self);
+	if (!file)
+		return NULL;
+
+	uint64_t pos = file->get_position();
+	uint64_t len = file->get_len();
+	Py_ssize_t size = len > pos ? (Py_ssize_t)(len - pos) : 0;
+	PyObject* ret = PyBytes_FromStringAndSize(NULL, size);
+	if (!ret || size == 0)
+		return ret;
+
+	Py_ssize_t read = 0;
+	FileIOData* data = file_io_data(p_self);
+	++data->busy;
+	Py_BEGIN_ALLOW_THREADS
+	while (read < size)
+	{
+		int chunk = size - read > INT32_MAX ? INT32_MAX : (int)(size - read);
+		int got = file->get_buffer((uint8_t*)PyBytes_AS_STRING(ret) + read, chunk);
+		if (got <= 0)
+			break;
+		read += got;
+	}
+	Py_END_ALLOW_THREADS
+	--data->busy;
+
+	if (read != size)
+		_PyBytes_Resize(&ret, read);
+	return ret;
+}
+
+static PyObject* file_io_write(PyObject* p_self, PyObject* p_arg)
+{
+	FileAccess* file = file_io_check(p_self);
+	if (!file)
+		return NULL;
+	if (!file_io_data(p_self)->writable)
+	{
+		PyErr_SetString(PyExc_OSError, "File not open for writing.");
+		return NULL;
+	}
+
+	Py_buffer view;
+	if (PyObject_GetBuffer(p_arg, &view, PyBUF_SIMPLE) != 0)
+		return NULL;
+
+	int len = view.len > INT32_MAX ? INT32_MAX : (int)view.len;
+	FileIOData* data = file_io_data(p_self);
+	++data->busy;
+	Py_BEGIN_ALLOW_THREADS
+	file->store_buffer((const uint8_t*)view.buf, len);
+	Py_END_ALLOW_THREADS
+	--data->busy;
+	PyBuffer_Release(&view);
+	return PyLong_FromLong(len);
+}
+
+static PyObject* file_io_seek(PyObject* p_self, PyObject* p_args)
+{
+	long long offset;
+	int whence = 0;
+	if (!PyArg_ParseTuple(p_args, "L|i:seek", &offset, &whence))
+		return NULL;
+	FileAccess* file = file_io_check(p_self);
+	if (!file)
+		return NULL;
+
+	// FileAccess::seek takes a size_t, so a negative position would wrap.
+	int64_t position;
+	switch (whence)
+	{
+	case 0:
+		position = offset;
+		break;
+	case 1:
+		position = (int64_t)file->get_position() + offset;
+		break;
+	case 2:
+		position = (int64_t)file->get_len() + offset;
+		break;
+	default:
+		PyErr_Format(PyExc_ValueError, "invalid whence (%d, should be 0, 1 or 2)", whence);
+		return NULL;
+	}
+	if (position < 0)
+	{
+		PyErr_SetString(PyExc_ValueError, "negative seek position");
+		return NULL;
+	}
+	file->seek(position);
+	return PyLong_FromUnsignedLongLong(file->get_position());
+}
+
+static PyObject* file_io_tell(PyObject* p_self, PyObject* p_unused)
+{
+	FileAccess* file = file_io_check(p_self);
+	if (!file)
+		return NULL;
+	return PyLong_FromUnsignedLongLong(file->get_position());
+}
+
+static PyObject* file_io_readable(PyObject* p_self, PyObject* p_unused)
+{
+	if (!file_io_check(p_self))
+		return NULL;
+	return PyBool_FromLong(file_io_data(p_self)->readable);
+}
+
+static PyObject* file_io_writable(PyObject* p_self, PyObject* p_unused)
+{
+	if (!file_io_check(p_self))
+		return NULL;
+	return PyBool_FromLong(file_io_data(p_self)->writable);
+}
+
+static PyObject* file_io_seekable(PyObject* p_self, PyObject* p_unused)
+{
+	if (!file_io_check(p_self))
+		return NULL;
+	Py_RETURN_TRUE;
+}
+
+static PyObject* file_io_close(PyObject* p_self, PyObject* p_unused)
+{
+	FileIOData* data = file_io_data(p_self);
+	file_io_wait_idle(data);
+	if (data->file)
+	{
+		data->file->close();
+		memdelete(data->file);
+		data->file = NULL;
+	}
+	return PyObject_CallMethod(raw_io_base, "close", "O", p_self);
+}
+
+static PyMethodDef file_io_methods[] =
+{
+	{ "readinto", (PyCFunction)file_io_readinto, METH_O, NULL },
+	{ "readall", (PyCFunction)file_io_readall, METH_NOARGS, NULL },
+	{ "write", (PyCFunction)file_io_write, METH_O, NULL },
+	{ "seek", (PyCFunction)file_io_seek, METH_VARARGS, NULL },
+	{ "tell", (PyCFunction)file_io_tell, METH_NOARGS, NULL },
+	{ "readable", (PyCFunction)file_io_readable, METH_NOARGS, NULL },
+	{ "writable", (PyCFunction)file_io_writable, METH_NOARGS, NULL },
+	{ "seekable", (PyCFunction)file_io_seekable, METH_NOARGS, NULL },
+	{ "close", (PyCFunction)file_io_close, METH_NOARGS, NULL },
+	{ NULL, NULL, 0, NULL }
+};
+
+static PyType_Slot file_io_slots[] =
+{
+	{ Py_tp_init, (void*)file_io_init },
+	{ Py_tp_methods, file_io_methods },
+	{ 0, NULL }
+};
+
+static PyType_Spec file_io_spec =
+{
+	"godot.FileAccessIO",
+	0,
+	0,
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+	file_io_slots
+};
+
+PyObject* file_io_create_type()
+{
+	if (file_io_type)
+	{
+		Py_INCREF(file_io_type);
+		return file_io_type;
+	}
+
+	PyObject* io = PyImport_ImportModule("_io");
+	if (!io)
+		return NULL;
+	raw_io_base = PyObject_GetAttrString(io, "_RawIOBase");
+	Py_DECREF(io);
+	if (!raw_io_base)
+		return NULL;
+
+	file_io_offset = ((PyTypeObject*)raw_io_base)->tp_basicsize;
+	file_io_spec.basicsize = (int)(file_io_offset + sizeof(FileIOData));
+	PyObject* bases = PyTuple_Pack(1, raw_io_base);
+	file_io_type = PyType_FromSpecWithBases(&file_io_spec, bases);
+	Py_DECREF(bases);
+	if (!file_io_type)
+		return NULL;
+
+	// io.RawIOBase is the ABC over _io._RawIOBase; register so isinstance checks pass.
+	PyObject* pyio = PyImport_ImportModule("io");
+	if (pyio)
+	{
+		PyObject* abc = PyObject_GetAttrString(pyio, "RawIOBase");
+		if (abc)
+		{
+			PyObject* ret = PyObject_CallMethod(abc, "register", "O", file_io_type);
+			Py_XDECREF(ret);
+			Py_DECREF(abc);
+		}
+		Py_DECREF(pyio);
+	}
+	PyErr_Clear();
+
+	Py_INCREF(file_io_type);
+	return file_io_type;
+}
+
+PyObject* file_io_open(PyObject* p_module, PyObject* p_args, PyObject* p_kwargs)
+{
+	static const char* kwlist[] = { "path", "mode", "encoding", NULL };
+	PyObject* path = NULL;
+	const char* mode = "r";
+	const char* encoding = "utf-8";
+	if (!PyArg_ParseTupleAndKeywords(p_args, p_kwargs, "U|ss:open", (char**)kwlist, &path, &mode, &encoding))
+		return NULL;
+
+	bool binary = strchr(mode, 'b') != NULL;
+	bool plus = strchr(mode, '+') != NULL;
+	bool write = strchr(mode, 'w') != NULL;
+	String rawMode = String(write ? "w" : "r") + (plus ? "+" : "");
+
+	PyObject* raw = PyObject_CallFunction(file_io_type, "Os", path, rawMode.utf8().get_data());
+	if (!raw)
+		return NULL;
+
+	PyObject* io = PyImport_ImportModule("io");
+	if (!io)
+	{
+		Py_DECREF(raw);
+		return NULL;
+	}
+	const char* bufferedName = plus ? "BufferedRandom" : (write ? "BufferedWriter" : "BufferedReader");
+	PyObject* buffered = PyObject_CallMethod(io, bufferedName, "O", raw);
+	Py_DECREF(raw);
+	PyObject* ret = buffered;
+	if (buffered && !binary)
+	{
+		ret = PyObject_CallMethod(io, "TextIOWrapper", "Os", buffered, encoding);
+		Py_DECREF(buffered);
+	}
+	Py_DECREF(io);
+	return ret;
+}
@@ -0,0 +1,12 @@
+#ifndef PY_FILE_IO_H
+#define PY_FILE_IO_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// godot.FileAccessIO: an io.RawIOBase over Godot's FileAccess (res://, user://, PCK entries).
+PyObject* file_io_create_type();
+// godot.open(path, mode="r"): FileAccessIO wrapped in a buffered reader/writer, plus a UTF-8 TextIOWrapper for text modes.
+PyObject* file_io_open(PyObject* p_module, PyObject* p_args, PyObject* p_kwargs);
+
+#endif
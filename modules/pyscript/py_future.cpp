@@ -0,0 +1,254 @@
+#include "py_future.h"
+#include "pyscript.h"
+#include "core/os/os.h"
+#include "scene/main/scene_tree.h"
+
+// Called with the finished asyncio task; p_self holds the PyFuture's instance id.
+static PyObject* future_done(PyObject* p_self, PyObject* p_task)
+{
+	ObjectID id = PyLong_AsUnsignedLongLong(p_self);
+	PyFuture* future = Object::cast_to<PyFuture>(ObjectDB::get_instance(id));
+	if (!future)
+		Py_RETURN_NONE;
+
+	PyObject* cancelled = PyObject_CallMethod(p_task, "cancelled", NULL);
+	bool isCancelled = cancelled == Py_True;
+	Py_XDECREF(cancelled);
+	if (isCancelled)
+	{
+		future->complete(Variant(), "Cancelled.");
+		Py_RETURN_NONE;
+	}
+
+	PyObject* exc = PyObject_CallMethod(p_task, "exception", NULL);
+	if (exc && exc != Py_None)
+	{
+		future->complete(Variant(), Python::get_singleton()->_str(exc));
+	}
+	else
+	{
+		PyObject* result = PyObject_CallMethod(p_task, "result", NULL);
+		if (result)
+			future->complete(PyScript::py2gd(result));
+		else
+			future->complete(Variant(), "Can't get the task result.");
+		Py_XDECREF(result);
+	}
+	Py_XDECREF(exc);
+	PyErr_Clear();
+	Py_RETURN_NONE;
+}
+
+PyMethodDef futureDoneDef =
+{
+	"future_done",
+	(PyCFunction)future_done,
+	METH_O,
+	NULL
+};
+
+PyObject* PyFuture::create_done_callback(PyFuture* p_future)
+{
+	PyObject* id = PyLong_FromUnsignedLongLong(p_future->get_instance_id());
+	if (!id)
+		return NULL;
+	PyObject* ret = PyCFunction_New(&futureDoneDef, id);
+	Py_DECREF(id);
+	return ret;
+}
+
+void PyFuture::set_task(PyObject* p_task)
+{
+	Py_XINCREF(p_task);
+	Py_XDECREF(m_task);
+	m_task = p_task;
+}
+
+void PyFuture::complete(const Variant& p_result, const String& p_error)
+{
+	if (m_done)
+		return;
+	m_done = true;
+	m_result = p_result;
+	m_error = p_error;
+	call_deferred("_emit_completed");
+}
+
+void PyFuture::_emit_completed()
+{
+	if (m_error != "")
+		ERR_PRINT(m_error);
+	emit_signal("completed", m_result);
+}
+
+bool PyFuture::is_done() const
+{
+	return m_done;
+}
+
+Variant PyFuture::get_result() const
+{
+	return m_result;
+}
+
+String PyFuture::get_error() const
+{
+	return m_error;
+}
+
+void PyFuture::cancel()
+{
+	if (m_done || !m_task)
+		return;
+	PyObject* ret = PyObject_CallMethod(m_task, "cancel", NULL);
+	if (!ret)
+		PyErr_Print();
+	Py_XDECREF(ret);
+}
+
+void PyFuture::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("is_done"), &PyFuture::is_done);
+	ClassDB::bind_method(D_METHOD("get_result"), &PyFuture::get_result);
+	ClassDB::bind_method(D_METHOD("get_error"), &PyFuture::get_error);
+	ClassDB::bind_method(D_METHOD("cancel"), &PyFuture::cancel);
+	ClassDB::bind_method(D_METHOD("_emit_completed"), &PyFuture::_emit_completed);
+
+	ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::NIL, "result")));
+}
+
+PyFuture::~PyFuture()
+{
+	Py_XDECREF(m_task);
+}
+
+Error PyFunctionState::start(PyObject* p_generator, Object* p_source, const StringName& p_signal, int p_steps, int p_budgetUsec)
+{
+	ERR_FAIL_COND_V_MSG(!p_generator || !PyObject_HasAttrString(p_generator, "send"), ERR_INVALID_PARAMETER, "Need a Python generator or coroutine.");
+	if (!p_source)
+	{
+		p_source = SceneTree::get_singleton();
+		ERR_FAIL_COND_V_MSG(!p_source, ERR_UNCONFIGURED, "Resuming each frame needs a running SceneTree.");
+	}
+	StringName signal = p_signal == StringName() ? StringName("idle_frame") : p_signal;
+	// The connection holds the reference that keeps this running after GDScript drops
+	// its own, like a GDScript yield does. Disconnecting, or freeing p_source, drops it.
+	Error err = p_source->connect(signal, this, "_signal_resume", varray(Ref<PyFunctionState>(this)));
+	if (err != OK)
+		return err;
+
+	Py_INCREF(p_generator);
+	m_generator = p_generator;
+	m_source = p_source->get_instance_id();
+	m_signal = signal;
+	m_steps = MAX(p_steps, 1);
+	m_budgetUsec = MAX(p_budgetUsec, 0);
+	return OK;
+}
+
+void PyFunctionState::finish(const Variant& p_result, const String& p_error)
+{
+	// Disconnecting may drop the last reference.
+	Ref<PyFunctionState> self(this);
+	Object* source = ObjectDB::get_instance(m_source);
+	if (source && source->is_connected(m_signal, this, "_signal_resume"))
+		source->disconnect(m_signal, this, "_signal_resume");
+	m_source = 0;
+	Py_XDECREF(m_generator);
+	m_generator = NULL;
+	complete(p_result, p_error);
+}
+
+// Returns false once the generator has finished.
+bool PyFunctionState::resume()
+{
+	if (!m_generator)
+		return false;
+
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < m_steps; ++i)
+	{
+		PyObject* value = PyObject_CallMethod(m_generator, "send", "O", Py_None);
+		if (value)
+		{
+			m_yielded = PyScript::py2gd(value);
+			Py_DECREF(value);
+			if (m_budgetUsec > 0 && OS::get_singleton()->get_ticks_usec() - start >= (uint64_t)m_budgetUsec)
+				break;
+			continue;
+		}
+
+		if (PyErr_ExceptionMatches(PyExc_StopIteration))
+		{
+			PyObject *type, *exc, *tb;
+			PyErr_Fetch(&type, &exc, &tb);
+			PyErr_NormalizeException(&type, &exc, &tb);
+			PyObject* result = exc ? PyObject_GetAttrString(exc, "value") : NULL;
+			PyErr_Clear();
+			Variant ret = PyScript::py2gd(result);
+			Py_XDECREF(result);
+			Py_XDECREF(type);
+			Py_XDECREF(exc);
+			Py_XDECREF(tb);
+			finish(ret, String());
+		}
+		else
+		{
+			PyObject *type, *exc, *tb;
+			PyErr_Fetch(&type, &exc, &tb);
+			PyErr_NormalizeException(&type, &exc, &tb);
+			String error = exc ? Python::get_singleton()->_str(exc) : String("Python error.");
+			PyErr_Restore(type, exc, tb);
+			PyErr_Print();
+			finish(Variant(), error);
+		}
+		return false;
+	}
+	return true;
+}
+
+Variant PyFunctionState::_signal_resume(const Variant** p_args, int p_argcount, Variant::CallError& r_error)
+{
+	r_error.error = Variant::CallError::CALL_OK;
+	// Hold a reference: finishing disconnects, which drops the one in the binds.
+	Ref<PyFunctionState> self(this);
+	return resume();
+}
+
+bool PyFunctionState::is_valid() const
+{
+	return m_generator != NULL;
+}
+
+Variant PyFunctionState::get_yielded() const
+{
+	return m_yielded;
+}
+
+void PyFunctionState::cancel()
+{
+	if (!m_generator)
+		return;
+	PyObject* ret = PyObject_CallMethod(m_generator, "close", NULL);
+	if (!ret)
+		PyErr_Print();
+	Py_XDECREF(ret);
+	finish(Variant(), "Cancelled.");
+}
+
+void PyFunctionState::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("resume"), &PyFunctionState::resume);
+	ClassDB::bind_method(D_METHOD("is_valid"), &PyFunctionState::is_valid);
+	ClassDB::bind_method(D_METHOD("get_yielded"), &PyFunctionState::get_yielded);
+	ClassDB::bind_method(D_METHOD("cancel"), &PyFunctionState::cancel);
+
+	MethodInfo mi;
+	mi.name = "_signal_resume";
+	ClassDB::bind_vararg_method(METHOD_FLAGS_DEFAULT, "_signal_resume", &PyFunctionState::_signal_resume, mi);
+}
+
+PyFunctionState::~PyFunctionState()
+{
+	Py_XDECREF(m_generator);
+}
@@ -0,0 +1,77 @@
+#ifndef PY_FUTURE_H
+#define PY_FUTURE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/reference.h"
+
+// Result of Python work finishing later, e.g. an asyncio task.
+// GDScript waits with: var result = yield(future, "completed")
+class PyFuture : public Reference
+{
+	GDCLASS(PyFuture, Reference);
+
+private:
+	bool m_done = false;
+	Variant m_result;
+	String m_error;
+	PyObject* m_task = NULL;
+
+	void _emit_completed();
+
+protected:
+	static void _bind_methods();
+
+public:
+	static PyObject* create_done_callback(PyFuture* p_future);
+
+	void set_task(PyObject* p_task);
+	PyObject* get_task() const { return m_task; }
+	// Stores the outcome and emits "completed" on the next message queue flush,
+	// so GDScript resumes outside the Python code that finished the work.
+	void complete(const Variant& p_result, const String& p_error = String());
+
+	bool is_done() const;
+	Variant get_result() const;
+	String get_error() const;
+	virtual void cancel();
+
+	PyFuture() {};
+	~PyFuture();
+};
+
+// Steps a Python generator or coroutine from GDScript, like GDScriptFunctionState.
+// Each resume sends None up to m_steps times (or until m_budgetUsec is spent);
+// StopIteration completes the future with its value.
+class PyFunctionState : public PyFuture
+{
+	GDCLASS(PyFunctionState, PyFuture);
+
+private:
+	PyObject* m_generator = NULL;
+	ObjectID m_source = 0;
+	StringName m_signal;
+	int m_steps = 1;
+	int m_budgetUsec = 0;
+	Variant m_yielded;
+
+	void finish(const Variant& p_result, const String& p_error);
+	Variant _signal_resume(const Variant** p_args, int p_argcount, Variant::CallError& r_error);
+
+protected:
+	static void _bind_methods();
+
+public:
+	// Resumes on p_signal of p_source, or on SceneTree idle_frame when p_source is NULL.
+	// The connection keeps this alive; if p_source is freed first it goes away unfinished.
+	Error start(PyObject* p_generator, Object* p_source, const StringName& p_signal, int p_steps, int p_budgetUsec);
+	bool resume();
+	bool is_valid() const;
+	Variant get_yielded() const;
+	virtual void cancel();
+
+	PyFunctionState() {};
+	~PyFunctionState();
+};
+
+#endif
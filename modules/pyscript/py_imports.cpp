@@ -0,0 +1,161 @@
+#include "py_imports.h"
+#include "core/os/os.h"
+#include "py_embed.h"
+#include "pyscript.h"
+#include <atomic>
+
+static const char* IMPORTS_SCRIPT = R"(import _frozen_importlib as bootstrap, threading, time
+
+original = bootstrap._find_and_load
+roots = []
+local = threading.local()
+started = 0
+
+def find_and_load(name, import_):
+    stack = getattr(local, "stack", None)
+    if stack is None:
+        stack = local.stack = [roots]
+    children = []
+    stack.append(children)
+    start = time.perf_counter_ns()
+    try:
+        return original(name, import_)
+    finally:
+        total = (time.perf_counter_ns() - start) // 1000
+        stack.pop()
+        own = total - sum(child["cumulative_usec"] for child in children)
+        stack[-1].append({"name": name, "self_usec": own, "cumulative_usec": total, "children": children})
+
+def profile(enabled):
+    global roots, local, started
+    if enabled:
+        roots = []
+        local = threading.local()
+        started = time.perf_counter_ns()
+        bootstrap._find_and_load = find_and_load
+    else:
+        bootstrap._find_and_load = original
+
+def report():
+    modules = sorted(roots, key=lambda node: -node["cumulative_usec"])
+    return {"total_usec": sum(node["cumulative_usec"] for node in roots), "modules": modules}
+
+preload_thread = None
+preload_result = {"loaded": [], "failed": {}}
+
+def preload_run(names, result):
+    try:
+        for name in names:
+            try:
+                __import__(name)
+                result["loaded"].append(name)
+            except BaseException as e:
+                result["failed"][name] = "%s: %s" % (type(e).__name__, e)
+    finally:
+        finished()
+
+def preload(names):
+    global preload_thread, preload_result
+    if preload_thread and preload_thread.is_alive():
+        return False
+    preload_result = {"loaded": [], "failed": {}}
+    preload_thread = threading.Thread(target=preload_run, args=(names, preload_result), name="pyscript-preload", daemon=True)
+    preload_thread.start()
+    return True
+
+def preloading():
+    return bool(preload_thread and preload_thread.is_alive())
+
+def result():
+    return preload_result
+)";
+
+// Set by the preload thread as its last step, so the main thread can see it without the GIL.
+static std::atomic<bool> preload_done(true);
+
+static PyObject* preload_finished(PyObject* p_self, PyObject* p_args)
+{
+	preload_done = true;
+	Py_RETURN_NONE;
+}
+
+static PyMethodDef imports_methods[] =
+{
+	{ "finished", (PyCFunction)preload_finished, METH_NOARGS, NULL },
+	{ NULL, NULL, 0, NULL }
+};
+
+static const PyEmbeddedModule IMPORTS_MODULE = { "_pyscript_imports", IMPORTS_SCRIPT, imports_methods };
+
+bool imports_set_profiling(bool p_enabled)
+{
+	PyObject* ret = embedded_call(IMPORTS_MODULE, "profile", p_enabled ? Py_True : Py_False);
+	Py_XDECREF(ret);
+	return ret != NULL;
+}
+
+Dictionary imports_get_profile()
+{
+	PyObject* ret = embedded_call(IMPORTS_MODULE, "report");
+	Dictionary profile = ret ? PyScript::py2gd(ret) : Variant();
+	Py_XDECREF(ret);
+	return profile;
+}
+
+bool imports_preload(const PoolStringArray& p_names)
+{
+	PyObject* names = PyList_New(p_names.size());
+	PoolStringArray::Read r = p_names.read();
+	for (int i = 0; i < p_names.size(); ++i)
+	{
+		PyList_SET_ITEM(names, i, PyUnicode_FromWideChar(r[i].ptr(), r[i].length()));
+	}
+	bool running = !preload_done;
+	preload_done = false;
+	PyObject* ret = embedded_call(IMPORTS_MODULE, "preload", names);
+	Py_DECREF(names);
+	bool started = ret == Py_True;
+	Py_XDECREF(ret);
+	if (!started)
+		preload_done = !running;
+	return started;
+}
+
+bool imports_is_preloading()
+{
+	PyObject* ret = embedded_call(IMPORTS_MODULE, "preloading");
+	bool running = ret == Py_True;
+	Py_XDECREF(ret);
+	return running;
+}
+
+bool imports_preload_yield(int p_usec)
+{
+	if (preload_done)
+		return false;
+
+	// Polls the flag rather than the thread, which would need the GIL, and stops as soon
+	// as the thread is done. Taking the GIL back waits for the thread to drop it: up to
+	// sys.getswitchinterval() while it runs bytecode, and for as long as a C call that
+	// holds the GIL takes (an extension module's init, for one).
+	OS* os = OS::get_singleton();
+	uint64_t start = os->get_ticks_usec();
+	PyThreadState* state = PyEval_SaveThread();
+	while (!preload_done)
+	{
+		uint64_t elapsed = os->get_ticks_usec() - start;
+		if (elapsed >= (uint64_t)p_usec)
+			break;
+		os->delay_usec(MIN(100, p_usec - elapsed));
+	}
+	PyEval_RestoreThread(state);
+	return !preload_done;
+}
+
+Dictionary imports_get_preload_result()
+{
+	PyObject* ret = embedded_call(IMPORTS_MODULE, "result");
+	Dictionary result = ret ? PyScript::py2gd(ret) : Variant();
+	Py_XDECREF(ret);
+	return result;
+}
@@ -0,0 +1,35 @@
+#ifndef PY_IMPORTS_H
+#define PY_IMPORTS_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/dictionary.h"
+#include "core/pool_vector.h"
+#include "core/ustring.h"
+
+// Import-time profiling and background imports, both done by a small embedded module.
+//
+// The profiler wraps importlib's _find_and_load, the function every import of a module
+// that isn't in sys.modules yet goes through (the same point -X importtime measures).
+// Each import becomes a node with its self and cumulative time and the imports it
+// triggered, per thread.
+//
+// Preloading imports modules on a Python thread. The main thread holds the GIL while
+// Godot runs, so the thread only makes progress while the main thread releases it,
+// which imports_preload_yield does for a bounded time.
+
+bool imports_set_profiling(bool p_enabled);
+// {total_usec, modules: [{name, self_usec, cumulative_usec, children: [...]}, ...]}
+Dictionary imports_get_profile();
+
+bool imports_preload(const PoolStringArray& p_names);
+bool imports_is_preloading();
+// Releases the GIL for at most p_usec, less if the preload finishes first, so the
+// preload thread can run. The call itself can take longer: getting the GIL back costs up
+// to sys.getswitchinterval() (5 ms by default) more, or the rest of a long C call the
+// thread is in. Returns false once the preload has finished.
+bool imports_preload_yield(int p_usec);
+// {loaded: [names], failed: {name: error}} of the last preload.
+Dictionary imports_get_preload_result();
+
+#endif
@@ -0,0 +1,81 @@
+#include "py_memo.h"
+
+int PyConvertMemo::maxDepth = 512;
+int PyConvertMemo::maxItems = 16 * 1024 * 1024;
+
+static inline uint64_t memo_key(const void* p_id, bool p_tuple)
+{
+	// Object addresses are at least 2-aligned, so the low bit is free for the tuple flag.
+	return (uint64_t)(uintptr_t)p_id | (p_tuple ? 1 : 0);
+}
+
+PyConvertMemo& PyConvertMemo::get()
+{
+	static thread_local PyConvertMemo memo;
+	return memo;
+}
+
+void PyConvertMemo::fail(const char* p_direction, const String& p_reason)
+{
+	if (m_failed)
+		return;
+	m_failed = true;
+	ERR_PRINT(String(p_direction) + ": " + p_reason + ", the conversion returns null.");
+}
+
+PyConvertMemo::Scope::Scope(const char* p_direction, int p_items) :
+		m_memo(PyConvertMemo::get())
+{
+	++m_memo.m_depth;
+	m_memo.m_items += p_items;
+	if (m_memo.m_depth > maxDepth)
+		m_memo.fail(p_direction, "nesting deeper than " + itos(maxDepth) + " levels (Python.conversion_max_depth)");
+	else if (m_memo.m_items > maxItems)
+		m_memo.fail(p_direction, "more than " + itos(maxItems) + " items (Python.conversion_max_items)");
+	m_ok = !m_memo.m_failed;
+}
+
+PyConvertMemo::Scope::~Scope()
+{
+	if (--m_memo.m_depth > 0)
+		return;
+	m_memo.m_items = 0;
+	m_memo.m_failed = false;
+	if (!m_memo.m_toGd.empty())
+		m_memo.m_toGd.clear();
+	if (!m_memo.m_toPy.empty())
+		m_memo.m_toPy.clear();
+}
+
+bool PyConvertMemo::find(PyObject* p_source, Variant& r_ret) const
+{
+	if (Py_REFCNT(p_source) <= 1 || m_toGd.empty())
+		return false;
+	const Variant* ret = m_toGd.getptr(memo_key(p_source, false));
+	if (!ret)
+		return false;
+	r_ret = *ret;
+	return true;
+}
+
+void PyConvertMemo::add(PyObject* p_source, const Variant& p_target)
+{
+	if (Py_REFCNT(p_source) > 1)
+		m_toGd.set(memo_key(p_source, false), p_target);
+}
+
+PyObject* PyConvertMemo::find(const void* p_id, bool p_tuple) const
+{
+	if (m_toPy.empty())
+		return NULL;
+	PyObject* const* ret = m_toPy.getptr(memo_key(p_id, p_tuple));
+	if (!ret)
+		return NULL;
+	Py_INCREF(*ret);
+	return *ret;
+}
+
+void PyConvertMemo::add(const void* p_id, bool p_tuple, PyObject* p_target)
+{
+	m_toPy.set(memo_key(p_id, p_tuple), p_target);
+}
@@ -0,0 +1,72 @@
+#ifndef PY_MEMO_H
+#define PY_MEMO_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/hash_map.h"
+#include "core/variant.h"
+
+// Per-thread memo table of one py2gd or gd2py call. Each container conversion opens a
+// Scope; the table is cleared when the outermost Scope ends. A container met again is
+// mapped to the target it already converted to, so shared substructures convert once
+// and cycles become shared references instead of endless recursion. Targets are put in
+// the table before their items are filled, which is what makes cycles terminate.
+// Sources are keyed by address, so the source graph must stay alive for the call.
+// Python objects with a reference count of 1 can't be shared and are never looked up.
+// Godot frees Arrays and Dictionaries by reference count alone, so a cycle from py2gd
+// leaks unless it is broken first, with Python.break_cycles() or by hand.
+//
+// The Scope also enforces the depth and item limits. The first violation prints an
+// error and fails the whole call: every container after it converts to null/None, and
+// the outermost converter returns null/None.
+class PyConvertMemo
+{
+private:
+	static int maxDepth;
+	static int maxItems;
+
+	HashMap<uint64_t, Variant> m_toGd;
+	HashMap<uint64_t, PyObject*> m_toPy;
+	int m_depth = 0;
+	int m_items = 0;
+	bool m_failed = false;
+
+	void fail(const char* p_direction, const String& p_reason);
+
+public:
+	class Scope
+	{
+	private:
+		PyConvertMemo& m_memo;
+		bool m_ok;
+
+	public:
+		// p_direction names the converter in the error, p_items is the container's size.
+		Scope(const char* p_direction, int p_items);
+		~Scope();
+
+		bool ok() const { return m_ok; }
+		// True for the container the call started at, which returns null/None on failure.
+		bool is_outermost() const { return m_memo.m_depth == 1; }
+		bool has_failed() const { return m_memo.m_failed; }
+		PyConvertMemo* operator->() { return &m_memo; }
+	};
+
+	static PyConvertMemo& get();
+	// Containers the current call is inside of.
+	int get_depth() const { return m_depth; }
+	static void set_max_depth(int p_depth) { maxDepth = MAX(p_depth, 1); }
+	static int get_max_depth() { return maxDepth; }
+	static void set_max_items(int p_items) { maxItems = MAX(p_items, 1); }
+	static int get_max_items() { return maxItems; }
+
+	bool find(PyObject* p_source, Variant& r_ret) const;
+	void add(PyObject* p_source, const Variant& p_target);
+	// New reference to what the Array/Dictionary with this id() converted to, or NULL.
+	// Arrays convert to lists or tuples, so the two are memoized separately.
+	PyObject* find(const void* p_id, bool p_tuple) const;
+	// p_target stays owned by the result being built.
+	void add(const void* p_id, bool p_tuple, PyObject* p_target);
+};
+
+#endif
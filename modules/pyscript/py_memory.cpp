@@ -0,0 +1,143 @@
+#include "py_memory.h"
+#include "py_embed.h"
+#include "pyscript.h"
+
+#ifdef WINDOWS_ENABLED
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+static const char* MEMORY_SCRIPT = R"(import gc, tracemalloc
+
+previous = None
+FILTERS = (tracemalloc.Filter(False, tracemalloc.__file__), tracemalloc.Filter(False, "<frozen importlib._bootstrap>"),
+           tracemalloc.Filter(False, "<unknown>"))
+
+def tracing(enabled):
+    global previous
+    if enabled and not tracemalloc.is_tracing():
+        tracemalloc.start(1)
+    elif not enabled and tracemalloc.is_tracing():
+        tracemalloc.stop()
+        previous = None
+
+def site(stat):
+    frame = stat.traceback[0]
+    return frame.filename, frame.lineno
+
+def snapshot(limit):
+    global previous
+    if not tracemalloc.is_tracing():
+        return {}
+    snap = tracemalloc.take_snapshot().filter_traces(FILTERS)
+    top = []
+    for stat in snap.statistics("lineno")[:limit]:
+        file, line = site(stat)
+        top.append({"file": file, "line": line, "size": stat.size, "count": stat.count})
+    diff = []
+    if previous is not None:
+        for stat in snap.compare_to(previous, "lineno")[:limit]:
+            file, line = site(stat)
+            diff.append({"file": file, "line": line, "size": stat.size, "size_diff": stat.size_diff,
+                         "count": stat.count, "count_diff": stat.count_diff})
+    previous = snap
+    current, peak = tracemalloc.get_traced_memory()
+    return {"current": current, "peak": peak, "top": top, "diff": diff}
+
+def traced():
+    return tracemalloc.get_traced_memory()[0] if tracemalloc.is_tracing() else -1
+
+def collect():
+    gc.collect()
+)";
+
+static const PyEmbeddedModule MEMORY_MODULE = { "_pyscript_memory", MEMORY_SCRIPT, NULL };
+
+static int64_t memory_call_int(const char* p_name)
+{
+	PyObject* ret = embedded_call(MEMORY_MODULE, p_name);
+	int64_t bytes = ret ? PyLong_AsLongLong(ret) : -1;
+	Py_XDECREF(ret);
+	return bytes;
+}
+
+bool memory_set_tracing(bool p_enabled)
+{
+	PyObject* ret = embedded_call(MEMORY_MODULE, "tracing", p_enabled ? Py_True : Py_False);
+	Py_XDECREF(ret);
+	return ret != NULL;
+}
+
+bool memory_is_tracing()
+{
+	return memory_traced() >= 0;
+}
+
+Dictionary memory_snapshot(int p_limit)
+{
+	PyObject* limit = PyLong_FromLong(MAX(p_limit, 0));
+	PyObject* ret = embedded_call(MEMORY_MODULE, "snapshot", limit);
+	Py_DECREF(limit);
+	Dictionary snapshot = ret ? PyScript::py2gd(ret) : Variant();
+	Py_XDECREF(ret);
+	return snapshot;
+}
+
+int64_t memory_traced()
+{
+	return memory_call_int("traced");
+}
+
+int64_t memory_rss()
+{
+#ifdef WINDOWS_ENABLED
+	// The kernel32 entry point, so nothing has to link psapi.
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return -1;
+	return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+		return -1;
+	return info.resident_size;
+#else
+	// The second field of statm is the resident page count.
+	FILE* f = fopen("/proc/self/statm", "r");
+	if (!f)
+		return -1;
+	long long pages = -1;
+	if (fscanf(f, "%*s %lld", &pages) != 1)
+		pages = -1;
+	fclose(f);
+	return pages < 0 ? -1 : pages * (int64_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+int64_t memory_used()
+{
+	int64_t traced = memory_traced();
+	return traced >= 0 ? traced : memory_rss();
+}
+
+int64_t memory_blocks()
+{
+	// What sys.getallocatedblocks() returns, without going through Python.
+	return _Py_GetAllocatedBlocks();
+}
+
+int64_t memory_collect()
+{
+	PyObject* ret = embedded_call(MEMORY_MODULE, "collect");
+	Py_XDECREF(ret);
+	return memory_used();
+}
@@ -0,0 +1,30 @@
+#ifndef PY_MEMORY_H
+#define PY_MEMORY_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/dictionary.h"
+
+// Python heap inspection through tracemalloc. Tracing is off until asked for, so it
+// costs nothing by default; with it on each allocation records one frame.
+
+bool memory_set_tracing(bool p_enabled);
+bool memory_is_tracing();
+// {current, peak, top: [{file, line, size, count}], diff: [{file, line, size, size_diff,
+// count, count_diff}]} with the p_limit largest sites. diff compares with the previous
+// snapshot and is empty for the first one. Empty when tracing is off.
+Dictionary memory_snapshot(int p_limit);
+// Bytes traced now, or -1 when tracing is off.
+int64_t memory_traced();
+// Resident set size of the whole process in bytes, or -1 where it can't be read.
+int64_t memory_rss();
+// Bytes in use: memory_traced() with tracing on, otherwise memory_rss().
+int64_t memory_used();
+// Memory blocks Python's object allocator has handed out and not freed. Counts objects
+// rather than bytes and misses the large buffers (over 512 bytes) that go straight to
+// malloc, so it is only reported next to memory_used().
+int64_t memory_blocks();
+// Full gc collection; returns memory_used() after it.
+int64_t memory_collect();
+
+#endif
@@ -0,0 +1,125 @@
+#include "py_multimesh.h"
+#include "py_object.h"
+#ifndef _3D_DISABLED
+#include "scene/3d/multimesh_instance.h"
+#endif
+#include "scene/resources/multimesh.h"
+#include "servers/visual_server.h"
+
+// Accepts a MultiMesh or a MultiMeshInstance proxy.
+static MultiMesh* multimesh_get(PyObject* p_obj)
+{
+	if (object_proxy_check(p_obj))
+	{
+		Object* obj = object_proxy_to_variant(p_obj);
+		MultiMesh* mm = Object::cast_to<MultiMesh>(obj);
+		if (mm)
+			return mm;
+#ifndef _3D_DISABLED
+		MultiMeshInstance* mmi = Object::cast_to<MultiMeshInstance>(obj);
+		if (mmi && mmi->get_multimesh().is_valid())
+			return mmi->get_multimesh().ptr();
+#endif
+	}
+	PyErr_SetString(PyExc_TypeError, "Need a MultiMesh or a MultiMeshInstance with a MultiMesh.");
+	return NULL;
+}
+
+// Layout of one instance in the bulk array: transform, then color, then custom data.
+static int multimesh_stride(MultiMesh* p_mm)
+{
+	int stride = p_mm->get_transform_format() == MultiMesh::TRANSFORM_2D ? 8 : 12;
+	switch (p_mm->get_color_format())
+	{
+	case MultiMesh::COLOR_8BIT:
+		stride += 1;
+		break;
+	case MultiMesh::COLOR_FLOAT:
+		stride += 4;
+		break;
+	default:
+		break;
+	}
+	switch (p_mm->get_custom_data_format())
+	{
+	case MultiMesh::CUSTOM_DATA_8BIT:
+		stride += 1;
+		break;
+	case MultiMesh::CUSTOM_DATA_FLOAT:
+		stride += 4;
+		break;
+	default:
+		break;
+	}
+	return stride;
+}
+
+PyObject* multimesh_py_stride(PyObject* p_module, PyObject* p_arg)
+{
+	MultiMesh* mm = multimesh_get(p_arg);
+	if (!mm)
+		return NULL;
+	return PyLong_FromLong(multimesh_stride(mm));
+}
+
+PyObject* multimesh_py_set_buffer(PyObject* p_module, PyObject* p_args)
+{
+	PyObject* target;
+	PyObject* source;
+	if (!PyArg_ParseTuple(p_args, "OO:multimesh_set_buffer", &target, &source))
+		return NULL;
+	MultiMesh* mm = multimesh_get(target);
+	if (!mm)
+		return NULL;
+
+	Py_buffer view;
+	if (PyObject_GetBuffer(source, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+		return NULL;
+
+	const char* format = view.format ? view.format : "B";
+	if (*format == '<' || *format == '=' || *format == '@')
+		++format;
+	bool isFloat = strcmp(format, "f") == 0 && view.itemsize == 4;
+	bool isDouble = strcmp(format, "d") == 0 && view.itemsize == 8;
+	if (!isFloat && !isDouble)
+	{
+		PyBuffer_Release(&view);
+		PyErr_Format(PyExc_TypeError, "Need a float32 or float64 buffer, got format '%s'.", view.format ? view.format : "B");
+		return NULL;
+	}
+
+	Py_ssize_t count = view.len / view.itemsize;
+	Py_ssize_t expected = (Py_ssize_t)mm->get_instance_count() * multimesh_stride(mm);
+	if (count != expected)
+	{
+		PyBuffer_Release(&view);
+		PyErr_Format(PyExc_ValueError, "Expected %zd floats (%d instances x %d), got %zd.", expected, mm->get_instance_count(), multimesh_stride(mm), count);
+		return NULL;
+	}
+
+	PoolRealArray data;
+	data.resize(count);
+	{
+		PoolRealArray::Write w = data.write();
+		if (isFloat && sizeof(real_t) == sizeof(float))
+		{
+			memcpy(w.ptr(), view.buf, view.len);
+		}
+		else if (isFloat)
+		{
+			const float* src = (const float*)view.buf;
+			for (Py_ssize_t i = 0; i < count; ++i)
+				w[i] = src[i];
+		}
+		else
+		{
+			const double* src = (const double*)view.buf;
+			for (Py_ssize_t i = 0; i < count; ++i)
+				w[i] = src[i];
+		}
+	}
+	PyBuffer_Release(&view);
+
+	VisualServer::get_singleton()->multimesh_set_as_bulk_array(mm->get_rid(), data);
+	Py_RETURN_NONE;
+}
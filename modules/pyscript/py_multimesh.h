@@ -0,0 +1,16 @@
+#ifndef PY_MULTIMESH_H
+#define PY_MULTIMESH_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+// Bulk MultiMesh updates from Python buffers (numpy arrays, array.array, memoryview).
+// The instance data goes to VisualServer::multimesh_set_as_bulk_array in one call, without
+// boxing each Transform or Color in a Variant.
+
+// godot.multimesh_stride(multimesh) -> floats per instance
+PyObject* multimesh_py_stride(PyObject* p_module, PyObject* p_arg);
+// godot.multimesh_set_buffer(multimesh, buffer)
+PyObject* multimesh_py_set_buffer(PyObject* p_module, PyObject* p_args);
+
+#endif
@@ -0,0 +1,130 @@
+#include "py_names.h"
+
+PyNameCache& PyNameCache::get()
+{
+	static PyNameCache cache;
+	return cache;
+}
+
+PyObject* PyNameCache::to_py(const StringName& p_name)
+{
+	PyObject** cached = m_toPy.getptr(p_name);
+	if (cached)
+	{
+		++m_hits;
+		Py_INCREF(*cached);
+		return *cached;
+	}
+
+	++m_misses;
+	String str = p_name;
+	PyObject* ret = PyUnicode_FromWideChar(str.ptr(), str.length());
+	if (!ret)
+		return NULL;
+	PyUnicode_InternInPlace(&ret);
+	if (m_toPy.size() >= m_capacity)
+		clear_to_py();
+	m_toPy.set(p_name, ret);
+	Py_INCREF(ret);
+	return ret;
+}
+
+PyObject* PyNameCache::get_attr(PyObject* p_obj, const StringName& p_name)
+{
+	PyObject* name = to_py(p_name);
+	if (!name)
+		return NULL;
+	PyObject* ret = PyObject_GetAttr(p_obj, name);
+	Py_DECREF(name);
+	return ret;
+}
+
+int PyNameCache::set_attr(PyObject* p_obj, const StringName& p_name, PyObject* p_value)
+{
+	PyObject* name = to_py(p_name);
+	if (!name)
+		return -1;
+	int ret = PyObject_SetAttr(p_obj, name, p_value);
+	Py_DECREF(name);
+	return ret;
+}
+
+StringName PyNameCache::to_name(PyObject* p_str)
+{
+	if (!PyUnicode_CHECK_INTERNED(p_str))
+	{
+		Py_ssize_t size;
+		const char* utf8 = PyUnicode_AsUTF8AndSize(p_str, &size);
+		String ret;
+		if (utf8)
+			ret.parse_utf8(utf8, size);
+		return ret;
+	}
+
+	uint64_t key = (uint64_t)(uintptr_t)p_str;
+	StringName* cached = m_toName.getptr(key);
+	if (cached)
+	{
+		++m_hits;
+		return *cached;
+	}
+
+	++m_misses;
+	Py_ssize_t size;
+	const char* utf8 = PyUnicode_AsUTF8AndSize(p_str, &size);
+	if (!utf8)
+		return StringName();
+	String str;
+	str.parse_utf8(utf8, size);
+	StringName ret = str;
+	if (m_toName.size() >= m_capacity)
+		clear_to_name();
+	Py_INCREF(p_str);
+	m_toName.set(key, ret);
+	m_toNameObjs.set(key, p_str);
+	return ret;
+}
+
+void PyNameCache::clear_to_py()
+{
+	const StringName* key = NULL;
+	while ((key = m_toPy.next(key)))
+	{
+		Py_DECREF(m_toPy[*key]);
+	}
+	m_toPy.clear();
+}
+
+void PyNameCache::clear_to_name()
+{
+	const uint64_t* key = NULL;
+	while ((key = m_toNameObjs.next(key)))
+	{
+		Py_DECREF(m_toNameObjs[*key]);
+	}
+	m_toNameObjs.clear();
+	m_toName.clear();
+}
+
+void PyNameCache::set_capacity(int p_capacity)
+{
+	m_capacity = MAX(p_capacity, 1);
+	if (m_toPy.size() > m_capacity)
+		clear_to_py();
+	if (m_toName.size() > m_capacity)
+		clear_to_name();
+}
+
+void PyNameCache::clear()
+{
+	clear_to_py();
+	clear_to_name();
+}
+
+PyNameCache::~PyNameCache()
+{
+	// The interpreter is gone by static destruction time; drop the pointers without DECREF.
+	m_toPy.clear();
+	m_toName.clear();
+	m_toNameObjs.clear();
+}
@@ -0,0 +1,50 @@
+#ifndef PY_NAMES_H
+#define PY_NAMES_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/hash_map.h"
+#include "core/string_name.h"
+
+// Maps StringName to interned Python str and back, so a repeated attribute name or
+// dict key costs one hash lookup instead of a UTF-8 round trip. Only touched with the
+// GIL held, which is what serializes it. When it holds more than m_capacity names in
+// either direction that side is cleared and refilled.
+class PyNameCache
+{
+private:
+	HashMap<StringName, PyObject*> m_toPy;
+	// Keyed by object address; each entry holds a reference so the address stays unique.
+	HashMap<uint64_t, StringName> m_toName;
+	HashMap<uint64_t, PyObject*> m_toNameObjs;
+	int m_capacity = 4096;
+	uint64_t m_hits = 0;
+	uint64_t m_misses = 0;
+
+	void clear_to_py();
+	void clear_to_name();
+
+public:
+	static PyNameCache& get();
+
+	// New reference to the interned str for p_name, or NULL with a Python error set.
+	// Callers own their reference, so a lookup that refills the cache (e.g. from a
+	// property getter) can't free a name that is still in use.
+	PyObject* to_py(const StringName& p_name);
+	// PyObject_GetAttr/PyObject_SetAttr through the cached name.
+	PyObject* get_attr(PyObject* p_obj, const StringName& p_name);
+	int set_attr(PyObject* p_obj, const StringName& p_name, PyObject* p_value);
+	// p_str must be a str. Only interned strings are cached; others convert directly.
+	StringName to_name(PyObject* p_str);
+
+	void set_capacity(int p_capacity);
+	int get_capacity() const { return m_capacity; }
+	uint64_t get_hits() const { return m_hits; }
+	uint64_t get_misses() const { return m_misses; }
+	int get_size() const { return m_toPy.size() + m_toName.size(); }
+	void clear();
+
+	~PyNameCache();
+};
+
+#endif
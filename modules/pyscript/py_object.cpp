@@ -0,0 +1,340 @@
+#include "py_object.h"
+#include "pyscript.h"
+#include "py_arena.h"
+#include "core/class_db.h"
+#include "core/engine.h"
+#include "core/reference.h"
+
+typedef struct ObjectProxy {
+	PyObject_HEAD
+	ObjectID id;
+	Reference* ref;
+}ObjectProxy;
+
+typedef struct MethodProxy {
+	PyObject_HEAD
+	MethodBind* bind;
+	StringName* name;
+}MethodProxy;
+
+static PyObject* object_type = NULL;
+static PyObject* method_type = NULL;
+static HashMap<StringName, PyObject*> class_types;
+
+static Object* object_proxy_get(PyObject* p_self)
+{
+	Object* obj = ObjectDB::get_instance(((ObjectProxy*)p_self)->id);
+	if (!obj)
+		PyErr_SetString(PyExc_ReferenceError, "The Godot object has been freed.");
+	return obj;
+}
+
+static PyObject* method_call(PyObject* p_self, PyObject* p_args, PyObject* p_kwargs)
+{
+	MethodProxy* method = (MethodProxy*)p_self;
+	Py_ssize_t argc = PyTuple_GET_SIZE(p_args) - 1;
+	if (argc < 0 || !object_proxy_check(PyTuple_GET_ITEM(p_args, 0)))
+	{
+		PyErr_Format(PyExc_TypeError, "'%s' must be called on a godot.Object.", String(*method->name).utf8().get_data());
+		return NULL;
+	}
+	if (p_kwargs && PyDict_GET_SIZE(p_kwargs) > 0)
+	{
+		PyErr_SetString(PyExc_TypeError, "Godot methods don't take keyword arguments.");
+		return NULL;
+	}
+	Object* obj = object_proxy_get(PyTuple_GET_ITEM(p_args, 0));
+	if (!obj)
+		return NULL;
+
+	PyScratchArena::Scope scope;
+	Variant* args = PyScratchArena::get().variants(argc);
+	const Variant** argptrs = PyScratchArena::get().pointers(argc);
+	for (int i = 0; i < argc; ++i)
+	{
+		args[i] = PyScript::py2gd(PyTuple_GET_ITEM(p_args, i + 1));
+		argptrs[i] = &args[i];
+	}
+
+	Variant::CallError err;
+	Variant ret = method->bind ? method->bind->call(obj, argptrs, argc, err) : obj->call(*method->name, argptrs, argc, err);
+	PyObject* pyRet = NULL;
+	if (err.error == Variant::CallError::CALL_OK)
+		pyRet = PyScript::gd2py_owned(ret);
+	else
+		PyErr_SetString(PyExc_TypeError, Variant::get_call_error_text(obj, *method->name, argptrs, argc, err).utf8().get_data());
+	return pyRet;
+}
+
+static PyObject* method_descr_get(PyObject* p_self, PyObject* p_obj, PyObject* p_type)
+{
+	if (!p_obj || p_obj == Py_None)
+	{
+		Py_INCREF(p_self);
+		return p_self;
+	}
+	return PyMethod_New(p_self, p_obj);
+}
+
+static void method_dealloc(PyObject* p_self)
+{
+	MethodProxy* method = (MethodProxy*)p_self;
+	if (method->name)
+		memdelete(method->name);
+	PyTypeObject* tp = Py_TYPE(p_self);
+	tp->tp_free(p_self);
+	Py_DECREF(tp);
+}
+
+static PyType_Slot method_slots[] =
+{
+	{ Py_tp_call, (void*)method_call },
+	{ Py_tp_descr_get, (void*)method_descr_get },
+	{ Py_tp_dealloc, (void*)method_dealloc },
+	{ 0, NULL }
+};
+
+static PyType_Spec method_spec =
+{
+	"godot.Method",
+	sizeof(MethodProxy),
+	0,
+	Py_TPFLAGS_DEFAULT,
+	method_slots
+};
+
+static PyObject* method_new(MethodBind* p_bind, const StringName& p_name)
+{
+	MethodProxy* method = PyObject_New(MethodProxy, (PyTypeObject*)method_type);
+	if (!method)
+		return NULL;
+	method->bind = p_bind;
+	method->name = memnew(StringName(p_name));
+	return (PyObject*)method;
+}
+
+static PyObject* object_getattro(PyObject* p_self, PyObject* p_name)
+{
+	PyObject* ret = PyObject_GenericGetAttr(p_self, p_name);
+	if (ret || !PyErr_ExceptionMatches(PyExc_AttributeError))
+		return ret;
+	PyErr_Clear();
+
+	Object* obj = object_proxy_get(p_self);
+	if (!obj)
+		return NULL;
+	const char* name = PyUnicode_AsUTF8(p_name);
+	if (!name)
+		return NULL;
+	StringName sname = String::utf8(name);
+
+	MethodBind* bind = ClassDB::get_method(obj->get_class_name(), sname);
+	if (bind)
+	{
+		PyObject* descr = method_new(bind, sname);
+		if (!descr)
+			return NULL;
+		// Later lookups find the descriptor in the type dict and skip ClassDB.
+		if (PyObject_SetAttr((PyObject*)Py_TYPE(p_self), p_name, descr) != 0)
+			PyErr_Clear();
+		ret = PyMethod_New(descr, p_self);
+		Py_DECREF(descr);
+		return ret;
+	}
+
+	bool valid = false;
+	Variant value = obj->get(sname, &valid);
+	if (valid)
+		return PyScript::gd2py_owned(value);
+
+	// Script methods differ per instance, so they go through Object::call and aren't cached.
+	if (obj->has_method(sname))
+	{
+		PyObject* descr = method_new(NULL, sname);
+		if (!descr)
+			return NULL;
+		ret = PyMethod_New(descr, p_self);
+		Py_DECREF(descr);
+		return ret;
+	}
+
+	PyErr_Format(PyExc_AttributeError, "'%s' object has no attribute '%s'", String(obj->get_class_name()).utf8().get_data(), name);
+	return NULL;
+}
+
+static int object_setattro(PyObject* p_self, PyObject* p_name, PyObject* p_value)
+{
+	Object* obj = object_proxy_get(p_self);
+	if (!obj)
+		return -1;
+	const char* name = PyUnicode_AsUTF8(p_name);
+	if (!name)
+		return -1;
+	if (!p_value)
+	{
+		PyErr_SetString(PyExc_AttributeError, "Can't delete attributes of a Godot object.");
+		return -1;
+	}
+
+	bool valid = false;
+	obj->set(String::utf8(name), PyScript::py2gd(p_value), &valid);
+	if (!valid)
+	{
+		PyErr_Format(PyExc_AttributeError, "'%s' object has no property '%s'", String(obj->get_class_name()).utf8().get_data(), name);
+		return -1;
+	}
+	return 0;
+}
+
+static PyObject* object_repr(PyObject* p_self)
+{
+	Object* obj = ObjectDB::get_instance(((ObjectProxy*)p_self)->id);
+	if (!obj)
+		return PyUnicode_FromString("<godot.Object [Deleted]>");
+	return PyUnicode_FromFormat("<godot.%s#%llu>", String(obj->get_class_name()).utf8().get_data(), (unsigned long long)((ObjectProxy*)p_self)->id);
+}
+
+static Py_hash_t object_hash(PyObject* p_self)
+{
+	Py_hash_t ret = (Py_hash_t)((ObjectProxy*)p_self)->id;
+	return ret == -1 ? -2 : ret;
+}
+
+static PyObject* object_richcompare(PyObject* p_self, PyObject* p_other, int p_op)
+{
+	if (!object_proxy_check(p_other) || (p_op != Py_EQ && p_op != Py_NE))
+		Py_RETURN_NOTIMPLEMENTED;
+	bool same = ((ObjectProxy*)p_self)->id == ((ObjectProxy*)p_other)->id;
+	return PyBool_FromLong(p_op == Py_EQ ? same : !same);
+}
+
+static void object_dealloc(PyObject* p_self)
+{
+	ObjectProxy* proxy = (ObjectProxy*)p_self;
+	if (proxy->ref && proxy->ref->unreference())
+		memdelete(proxy->ref);
+	proxy->ref = NULL;
+	PyTypeObject* tp = Py_TYPE(p_self);
+	tp->tp_free(p_self);
+	Py_DECREF(tp);
+}
+
+static PyType_Slot object_slots[] =
+{
+	{ Py_tp_getattro, (void*)object_getattro },
+	{ Py_tp_setattro, (void*)object_setattro },
+	{ Py_tp_repr, (void*)object_repr },
+	{ Py_tp_hash, (void*)object_hash },
+	{ Py_tp_richcompare, (void*)object_richcompare },
+	{ Py_tp_dealloc, (void*)object_dealloc },
+	{ 0, NULL }
+};
+
+static PyType_Spec object_spec =
+{
+	"godot.Object",
+	sizeof(ObjectProxy),
+	0,
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+	object_slots
+};
+
+// Proxy type for p_class, created on first use with the parent class's type as base.
+static PyObject* class_type(const StringName& p_class)
+{
+	if (p_class == StringName() || p_class == StringName("Object"))
+		return object_type;
+	PyObject** cached = class_types.getptr(p_class);
+	if (cached)
+		return *cached;
+
+	PyObject* base = class_type(ClassDB::get_parent_class_nocheck(p_class));
+	if (!base)
+		return NULL;
+	PyObject* tp = PyObject_CallFunction((PyObject*)&PyType_Type, "s(O){s:(),s:s}", String(p_class).utf8().get_data(), base, "__slots__", "__module__", "godot");
+	if (!tp)
+		return NULL;
+	class_types.set(p_class, tp);
+	return tp;
+}
+
+PyObject* object_proxy_create_type()
+{
+	if (!method_type)
+	{
+		method_type = PyType_FromSpec(&method_spec);
+		if (!method_type)
+			return NULL;
+	}
+	if (!object_type)
+	{
+		object_type = PyType_FromSpec(&object_spec);
+		if (!object_type)
+			return NULL;
+	}
+	Py_INCREF(object_type);
+	return object_type;
+}
+
+bool object_proxy_check(PyObject* p_obj)
+{
+	return object_type && PyObject_TypeCheck(p_obj, (PyTypeObject*)object_type);
+}
+
+PyObject* object_proxy_new(Object* p_obj)
+{
+	if (!p_obj)
+		Py_RETURN_NONE;
+	if (!object_type)
+	{
+		// The godot module registers the types; importing it once is enough.
+		PyObject* mod = PyImport_ImportModule("godot");
+		if (!mod)
+			return NULL;
+		Py_DECREF(mod);
+	}
+
+	PyObject* tp = class_type(p_obj->get_class_name());
+	if (!tp)
+		return NULL;
+	ObjectProxy* proxy = PyObject_New(ObjectProxy, (PyTypeObject*)tp);
+	if (!proxy)
+		return NULL;
+	proxy->id = p_obj->get_instance_id();
+	proxy->ref = Object::cast_to<Reference>(p_obj);
+	if (proxy->ref && !proxy->ref->reference())
+		proxy->ref = NULL;
+	return (PyObject*)proxy;
+}
+
+Variant object_proxy_to_variant(PyObject* p_proxy)
+{
+	ObjectProxy* proxy = (ObjectProxy*)p_proxy;
+	if (proxy->ref)
+		return REF(proxy->ref);
+	Object* obj = ObjectDB::get_instance(proxy->id);
+	return obj ? Variant(obj) : Variant();
+}
+
+PyObject* object_proxy_get_singleton(PyObject* p_module, PyObject* p_arg)
+{
+	const char* name = PyUnicode_AsUTF8(p_arg);
+	if (!name)
+		return NULL;
+	Object* obj = Engine::get_singleton()->get_singleton_object(String::utf8(name));
+	if (!obj)
+	{
+		PyErr_Format(PyExc_KeyError, "No Godot singleton named '%s'.", name);
+		return NULL;
+	}
+	return object_proxy_new(obj);
+}
+
+void object_proxy_clear_types()
+{
+	for (const StringName* key = class_types.next(NULL); key; key = class_types.next(key))
+	{
+		Py_DECREF(class_types[*key]);
+	}
+	class_types.clear();
+}
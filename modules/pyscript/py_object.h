@@ -0,0 +1,25 @@
+#ifndef PY_OBJECT_H
+#define PY_OBJECT_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/object.h"
+
+// godot.Object: Python proxies over engine objects. Each Godot class gets its own proxy
+// type (godot.Node derives from godot.Object, ...); a method is resolved through ClassDB
+// the first time it is looked up and its descriptor is stored on that type, so later
+// calls go straight to MethodBind::call with arguments in the scratch arena.
+
+PyObject* object_proxy_create_type();
+bool object_proxy_check(PyObject* p_obj);
+// New proxy; holds a reference when p_obj is a Reference. Returns None for NULL.
+PyObject* object_proxy_new(Object* p_obj);
+Variant object_proxy_to_variant(PyObject* p_proxy);
+
+// godot.get_singleton(name)
+PyObject* object_proxy_get_singleton(PyObject* p_module, PyObject* p_arg);
+// Drops the per-class proxy types. Called at shutdown while Python and StringName still
+// work; the static table would otherwise outlive both.
+void object_proxy_clear_types();
+
+#endif
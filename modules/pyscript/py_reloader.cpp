@@ -0,0 +1,288 @@
+#include "py_reloader.h"
+#include "pyscript.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+
+static bool path_has_prefix(const String& p_path, const char* p_sysAttr)
+{
+	PyObject* prefix = PySys_GetObject(p_sysAttr);
+	if (!prefix || !PyUnicode_Check(prefix))
+		return false;
+	String ret = PyScript::py2gd(prefix);
+	return ret != "" && p_path.begins_with(ret);
+}
+
+// Only plain .py sources outside the interpreter's prefix (stdlib, site-packages) are watched.
+bool PyReloader::get_watch_path(PyObject* p_module, String& r_path) const
+{
+	PyObject* file = PyObject_GetAttrString(p_module, "__file__");
+	if (!file)
+	{
+		PyErr_Clear();
+		return false;
+	}
+	if (PyUnicode_Check(file))
+	{
+		r_path = PyScript::py2gd(file);
+	}
+	Py_DECREF(file);
+
+	if (!r_path.ends_with(".py"))
+		return false;
+	return !path_has_prefix(r_path, "base_prefix") && !path_has_prefix(r_path, "prefix");
+}
+
+void PyReloader::track(PyObject* p_module)
+{
+	if (!p_module || !PyModule_Check(p_module))
+		return;
+
+	const char* name = PyModule_GetName(p_module);
+	if (!name)
+	{
+		PyErr_Clear();
+		return;
+	}
+	String modName = name;
+	if (m_modules.has(modName))
+		return;
+
+	String path;
+	if (!get_watch_path(p_module, path))
+		return;
+
+	ModuleData md;
+	md.path = path;
+	md.mtime = FileAccess::get_modified_time(path);
+	m_modules[modName] = md;
+	m_scanOrder.push_back(modName);
+	scan_deps(modName, p_module);
+}
+
+// A module depends on the modules it holds and on the modules its classes and functions come from.
+void PyReloader::scan_deps(const String& p_name, PyObject* p_module)
+{
+	Set<String> deps;
+	PyObject* sysModules = PyImport_GetModuleDict();
+	PyObject* dict = PyModule_GetDict(p_module);
+	PyObject* key, * value;
+	Py_ssize_t pos = 0;
+
+	while (PyDict_Next(dict, &pos, &key, &value))
+	{
+		String dep;
+		if (PyModule_Check(value))
+		{
+			const char* name = PyModule_GetName(value);
+			if (name)
+				dep = name;
+			else
+				PyErr_Clear();
+		}
+		else if (PyType_Check(value) || PyFunction_Check(value))
+		{
+			PyObject* modAttr = PyObject_GetAttrString(value, "__module__");
+			if (modAttr && PyUnicode_Check(modAttr))
+				dep = PyScript::py2gd(modAttr);
+			Py_XDECREF(modAttr);
+			PyErr_Clear();
+		}
+
+		if (dep == "" || dep == p_name || deps.has(dep))
+			continue;
+
+		PyObject* depMod = PyDict_GetItemString(sysModules, dep.utf8().get_data());
+		if (!depMod)
+			continue;
+		track(depMod);
+		if (m_modules.has(dep))
+			deps.insert(dep);
+	}
+
+	auto E = m_modules.find(p_name);
+	if (E)
+		E->get().deps = deps;
+}
+
+void PyReloader::sort_visit(const String& p_name, const Set<String>& p_set, Set<String>& r_visited, List<String>& r_order) const
+{
+	if (r_visited.has(p_name))
+		return;
+	r_visited.insert(p_name);
+
+	auto E = m_modules.find(p_name);
+	if (E)
+	{
+		for (auto D = E->get().deps.front(); D; D = D->next())
+		{
+			if (p_set.has(D->get()))
+				sort_visit(D->get(), p_set, r_visited, r_order);
+		}
+	}
+	r_order.push_back(p_name);
+}
+
+// Queues the changed modules and everything that depends on them, dependencies first.
+void PyReloader::queue_reload(const Set<String>& p_changed)
+{
+	Set<String> reloadSet = p_changed;
+	bool grown = true;
+	while (grown)
+	{
+		grown = false;
+		for (auto E = m_modules.front(); E; E = E->next())
+		{
+			if (reloadSet.has(E->key()))
+				continue;
+			for (auto D = E->get().deps.front(); D; D = D->next())
+			{
+				if (reloadSet.has(D->get()))
+				{
+					reloadSet.insert(E->key());
+					grown = true;
+					break;
+				}
+			}
+		}
+	}
+
+	Set<String> visited;
+	List<String> order;
+	for (auto E = reloadSet.front(); E; E = E->next())
+	{
+		sort_visit(E->get(), reloadSet, visited, order);
+	}
+
+	for (auto E = order.front(); E; E = E->next())
+	{
+		if (!m_pending.find(E->get()))
+			m_pending.push_back(E->get());
+	}
+}
+
+void PyReloader::swap_scripts(const String& p_name, PyObject* p_old, PyObject* p_new)
+{
+	auto nameUtf8 = p_name.utf8();
+	for (SelfList<PyScript>* E = PyScript::script_list.first(); E; E = E->next())
+	{
+		PyScript* script = E->self();
+		PyObject* obj = script->get_module();
+		if (!obj)
+			continue;
+
+		if (obj == p_old)
+		{
+			if (p_new != p_old)
+				script->set_module(p_new);
+			continue;
+		}
+		if (!PyType_Check(obj))
+			continue;
+
+		PyObject* modAttr = PyObject_GetAttrString(obj, "__module__");
+		bool fromModule = modAttr && PyUnicode_Check(modAttr) && PyUnicode_CompareWithASCIIString(modAttr, nameUtf8.get_data()) == 0;
+		Py_XDECREF(modAttr);
+		PyObject* qualname = fromModule ? PyObject_GetAttrString(obj, "__qualname__") : NULL;
+		PyErr_Clear();
+		if (!qualname)
+			continue;
+
+		Vector<String> parts = String(PyScript::py2gd(qualname)).split(".");
+		Py_DECREF(qualname);
+		PyObject* found = p_new;
+		Py_INCREF(found);
+		for (int i = 0; i < parts.size() && found; ++i)
+		{
+			PyObject* next = PyObject_GetAttrString(found, parts[i].utf8().get_data());
+			Py_DECREF(found);
+			found = next;
+		}
+		PyErr_Clear();
+
+		if (found && found != obj && PyType_Check(found))
+			script->set_module(found);
+		Py_XDECREF(found);
+	}
+}
+
+bool PyReloader::reload_module(const String& p_name)
+{
+	PyObject* old = PyDict_GetItemString(PyImport_GetModuleDict(), p_name.utf8().get_data());
+	if (!old)
+		return false;
+
+	Py_INCREF(old);
+	PyObject* mod = PyImport_ReloadModule(old);
+	if (!mod)
+	{
+		PyErr_Print();
+		Py_DECREF(old);
+		return false;
+	}
+
+	swap_scripts(p_name, old, mod);
+	auto E = m_modules.find(p_name);
+	if (E)
+	{
+		E->get().mtime = FileAccess::get_modified_time(E->get().path);
+		scan_deps(p_name, mod);
+	}
+	Py_DECREF(mod);
+	Py_DECREF(old);
+	return true;
+}
+
+// Reloads queued modules, then checks file times round-robin, until p_budgetUsec is spent.
+// At least one reload or one check is done per step; a zero budget means no limit.
+int PyReloader::step(uint64_t p_budgetUsec)
+{
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	int ret = 0;
+	while (!m_pending.empty())
+	{
+		String name = m_pending.front()->get();
+		m_pending.pop_front();
+		if (reload_module(name))
+			++ret;
+		if (p_budgetUsec && OS::get_singleton()->get_ticks_usec() - start >= p_budgetUsec)
+			return ret;
+	}
+
+	Set<String> changed;
+	for (int i = 0; i < m_scanOrder.size(); ++i)
+	{
+		if (m_scanCursor >= m_scanOrder.size())
+			m_scanCursor = 0;
+		auto E = m_modules.find(m_scanOrder[m_scanCursor++]);
+		uint64_t mtime = FileAccess::get_modified_time(E->get().path);
+		if (mtime != E->get().mtime)
+		{
+			E->get().mtime = mtime;
+			changed.insert(E->key());
+		}
+		if (p_budgetUsec && OS::get_singleton()->get_ticks_usec() - start >= p_budgetUsec)
+			break;
+	}
+
+	if (!changed.empty())
+		queue_reload(changed);
+	return ret;
+}
+
+int PyReloader::reload_changed()
+{
+	int ret = step(0);
+	while (!m_pending.empty())
+	{
+		ret += step(0);
+	}
+	return ret;
+}
+
+void PyReloader::clear()
+{
+	m_modules.clear();
+	m_scanOrder.clear();
+	m_scanCursor = 0;
+	m_pending.clear();
+}
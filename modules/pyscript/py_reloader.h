@@ -0,0 +1,43 @@
+#ifndef PY_RELOADER_H
+#define PY_RELOADER_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/list.h"
+#include "core/map.h"
+#include "core/set.h"
+#include "core/ustring.h"
+#include "core/vector.h"
+
+// Watches the source files of modules loaded through PyScript::set_path (and the
+// project modules they import), reloads changed ones with their dependents and
+// points every live PyScript at the new module/class objects.
+class PyReloader
+{
+private:
+	typedef struct ModuleData {
+		String path;
+		uint64_t mtime = 0;
+		Set<String> deps;
+	}ModuleData;
+
+	Map<String, ModuleData> m_modules;
+	Vector<String> m_scanOrder;
+	int m_scanCursor = 0;
+	List<String> m_pending;
+
+	bool get_watch_path(PyObject* p_module, String& r_path) const;
+	void scan_deps(const String& p_name, PyObject* p_module);
+	void queue_reload(const Set<String>& p_changed);
+	void sort_visit(const String& p_name, const Set<String>& p_set, Set<String>& r_visited, List<String>& r_order) const;
+	void swap_scripts(const String& p_name, PyObject* p_old, PyObject* p_new);
+
+public:
+	void track(PyObject* p_module);
+	bool reload_module(const String& p_name);
+	int step(uint64_t p_budgetUsec);
+	int reload_changed();
+	void clear();
+};
+
+#endif
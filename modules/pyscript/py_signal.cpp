@@ -0,0 +1,111 @@
+#include "py_signal.h"
+#include "py_arena.h"
+#include "pyscript.h"
+
+Error PySignalReceiver::connect_to(Object* p_source, const StringName& p_signal, PyObject* p_callable, const Array& p_binds, uint32_t p_flags)
+{
+	ERR_FAIL_COND_V_MSG(m_callable, ERR_ALREADY_IN_USE, "The receiver is already connected.");
+	ERR_FAIL_COND_V_MSG(!p_source, ERR_INVALID_PARAMETER, "Need an object to connect to.");
+	ERR_FAIL_COND_V_MSG(!p_callable || !PyCallable_Check(p_callable), ERR_INVALID_PARAMETER, "Need a Python callable.");
+
+	Error err = p_source->connect(p_signal, this, "_emit", Vector<Variant>(), p_flags);
+	if (err != OK)
+		return err;
+
+	Py_INCREF(p_callable);
+	m_callable = p_callable;
+	m_binds.resize(p_binds.size());
+	for (int i = 0; i < p_binds.size(); ++i)
+	{
+		m_binds.write[i] = PyScript::gd2py_owned(p_binds[i]);
+	}
+	m_source = p_source->get_instance_id();
+	m_signal = p_signal;
+	return OK;
+}
+
+void PySignalReceiver::disconnect_from()
+{
+	Object* source = ObjectDB::get_instance(m_source);
+	if (source && source->is_connected(m_signal, this, "_emit"))
+		source->disconnect(m_signal, this, "_emit");
+	m_source = 0;
+	for (int i = 0; i < m_binds.size(); ++i)
+	{
+		Py_DECREF(m_binds[i]);
+	}
+	m_binds.clear();
+	Py_XDECREF(m_callable);
+	m_callable = NULL;
+}
+
+bool PySignalReceiver::is_connected_to() const
+{
+	Object* source = ObjectDB::get_instance(m_source);
+	return source && source->is_connected(m_signal, (Object*)this, "_emit");
+}
+
+bool PySignalReceiver::is_source(Object* p_source, const StringName& p_signal, PyObject* p_callable) const
+{
+	if (!m_callable || !p_source || p_source->get_instance_id() != m_source || p_signal != m_signal)
+		return false;
+	// Bound methods are new objects on each access but compare equal.
+	int equal = PyObject_RichCompareBool(m_callable, p_callable, Py_EQ);
+	if (equal < 0)
+		PyErr_Clear();
+	return equal > 0;
+}
+
+Variant PySignalReceiver::_emit(const Variant** p_args, int p_argcount, Variant::CallError& r_error)
+{
+	r_error.error = Variant::CallError::CALL_OK;
+	if (!m_callable)
+		return Variant();
+
+	// One slot in front for PY_VECTORCALL_ARGUMENTS_OFFSET, so a bound method can put
+	// self there instead of copying the arguments.
+	PyScratchArena::Scope scope;
+	int argc = p_argcount + m_binds.size();
+	PyObject** args = (PyObject**)PyScratchArena::get().alloc(sizeof(PyObject*) * (argc + 1)) + 1;
+	for (int i = 0; i < p_argcount; ++i)
+	{
+		args[i] = PyScript::gd2py(p_args[i]);
+	}
+	// The callable and binds are held for the call: the handler may disconnect this receiver.
+	for (int i = p_argcount; i < argc; ++i)
+	{
+		args[i] = m_binds[i - p_argcount];
+		Py_INCREF(args[i]);
+	}
+	PyObject* callable = m_callable;
+	Py_INCREF(callable);
+	PyObject* ret = PyObject_Vectorcall(callable, args, argc | PY_VECTORCALL_ARGUMENTS_OFFSET, NULL);
+	Py_DECREF(callable);
+	for (int i = 0; i < argc; ++i)
+	{
+		if (i >= p_argcount || args[i] != Py_None)
+			Py_XDECREF(args[i]);
+	}
+	if (!ret)
+	{
+		PyErr_Print();
+		return Variant();
+	}
+	Py_DECREF(ret);
+	return Variant();
+}
+
+void PySignalReceiver::_bind_methods()
+{
+	ClassDB::bind_method(D_METHOD("disconnect_from"), &PySignalReceiver::disconnect_from);
+	ClassDB::bind_method(D_METHOD("is_connected_to"), &PySignalReceiver::is_connected_to);
+
+	MethodInfo mi;
+	mi.name = "_emit";
+	ClassDB::bind_vararg_method(METHOD_FLAGS_DEFAULT, "_emit", &PySignalReceiver::_emit, mi);
+}
+
+PySignalReceiver::~PySignalReceiver()
+{
+	disconnect_from();
+}
@@ -0,0 +1,40 @@
+#ifndef PY_SIGNAL_H
+#define PY_SIGNAL_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/reference.h"
+#include "core/vector.h"
+
+// Native target of a Godot signal that calls a Python callable. The callable and the
+// binds are resolved once at connect time; each emission converts the signal arguments
+// with gd2py and makes one vectorcall, without a GDScript method in between.
+class PySignalReceiver : public Reference
+{
+	GDCLASS(PySignalReceiver, Reference);
+
+private:
+	PyObject* m_callable = NULL;
+	Vector<PyObject*> m_binds;
+	ObjectID m_source = 0;
+	StringName m_signal;
+
+	Variant _emit(const Variant** p_args, int p_argcount, Variant::CallError& r_error);
+
+protected:
+	static void _bind_methods();
+
+public:
+	// Binds are passed after the signal's own arguments, like Object.connect binds.
+	Error connect_to(Object* p_source, const StringName& p_signal, PyObject* p_callable, const Array& p_binds, uint32_t p_flags);
+	void disconnect_from();
+	// False once disconnected, after a oneshot emission, or when the source was freed.
+	bool is_connected_to() const;
+	// True when this receiver connects p_source's p_signal to a callable equal to p_callable.
+	bool is_source(Object* p_source, const StringName& p_signal, PyObject* p_callable) const;
+
+	PySignalReceiver() {};
+	~PySignalReceiver();
+};
+
+#endif
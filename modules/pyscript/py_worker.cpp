@@ -0,0 +1,756 @@
+#include "py_worker.h"
+#include "pyscript.h"
+#include "core/io/marshalls.h"
+#include "core/os/file_access.h"
+#include <marshal.h>
+#include <atomic>
+
+#ifdef WINDOWS_ENABLED
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Segment layout, shared with the worker script below. All values are little-endian.
+#define WORKER_MAGIC 0x4b575950 // "PYWK"
+#define WORKER_HEADER_SIZE 128
+#define WORKER_OFF_RING 8
+#define WORKER_OFF_HEARTBEAT 16
+#define WORKER_OFF_STATE 24
+#define WORKER_OFF_REQ_HEAD 32
+#define WORKER_OFF_REQ_TAIL 40
+#define WORKER_OFF_RESP_HEAD 48
+#define WORKER_OFF_RESP_TAIL 56
+
+#define WORKER_STATE_STOP 2
+
+// How long stop() waits for workers to exit on their own before killing them.
+#define WORKER_STOP_USEC 50000
+// A worker that dies before its first heartbeat is restarted at once, then after 100 ms,
+// then twice as late each time, and given up on after this many tries in a row.
+#define WORKER_RESTART_USEC 100000
+#define WORKER_MAX_RESTARTS 5
+// Results delivered through take_completed() that take_result() can still claim.
+#define WORKER_KEEP_DELIVERED 256
+
+enum {
+	KIND_CALL = 1,
+	KIND_CALL_SHM = 2,
+	KIND_RESULT = 3,
+	KIND_ERROR = 4,
+	KIND_RESULT_SHM = 5,
+	KIND_RELEASE = 6,
+};
+
+static const char* WORKER_SCRIPT = R"(import importlib, marshal, os, struct, sys, threading, time, traceback
+from multiprocessing import shared_memory
+
+def attach(name):
+    seg = shared_memory.SharedMemory(name)
+    if os.name == "posix":
+        from multiprocessing import resource_tracker
+        resource_tracker.unregister(seg._name, "shared_memory")
+    return seg
+
+shm = attach(sys.argv[1])
+sys.path[:0] = sys.argv[2:]
+buf = shm.buf
+ring = struct.unpack_from("<Q", buf, 8)[0]
+REQ, RESP = 128, 128 + ring
+held = {}
+
+def stopping():
+    return struct.unpack_from("<I", buf, 24)[0] == 2
+
+def beat():
+    n = 0
+    while not stopping():
+        n += 1
+        struct.pack_into("<Q", buf, 16, n)
+        time.sleep(0.1)
+
+def get(base, pos, n):
+    start = pos % ring
+    first = min(n, ring - start)
+    out = bytes(buf[base + start:base + start + first])
+    if first < n:
+        out += bytes(buf[base:base + n - first])
+    return out
+
+def put(base, pos, data):
+    start = pos % ring
+    first = min(len(data), ring - start)
+    buf[base + start:base + start + first] = data[:first]
+    if first < len(data):
+        buf[base:base + len(data) - first] = data[first:]
+
+def read():
+    head, tail = struct.unpack_from("<QQ", buf, 32)
+    if head == tail:
+        return None
+    length, kind, cid = struct.unpack("<IIQ", get(REQ, tail, 16))
+    data = get(REQ, tail + 16, length)
+    struct.pack_into("<Q", buf, 40, tail + ((16 + length + 7) & ~7))
+    return kind, cid, data
+
+def write(kind, cid, payload):
+    total = (16 + len(payload) + 7) & ~7
+    while True:
+        head, tail = struct.unpack_from("<QQ", buf, 48)
+        if ring - (head - tail) >= total:
+            break
+        if stopping():
+            return
+        time.sleep(0.0005)
+    put(RESP, head, struct.pack("<IIQ", len(payload), kind, cid) + payload)
+    struct.pack_into("<Q", buf, 48, head + total)
+
+def run(kind, cid, data):
+    if kind == 2:
+        size = struct.unpack_from("<Q", data)[0]
+        seg = attach(data[8:].decode())
+        try:
+            call = marshal.loads(seg.buf[:size])
+        finally:
+            seg.close()
+    else:
+        call = marshal.loads(data)
+    module, function, args = call
+    payload = marshal.dumps(getattr(importlib.import_module(module), function)(*args))
+    if len(payload) > ring // 4:
+        seg = shared_memory.SharedMemory(create=True, size=len(payload))
+        seg.buf[:len(payload)] = payload
+        held[seg.name] = seg
+        write(5, cid, struct.pack("<Q", len(payload)) + seg.name.encode())
+    else:
+        write(3, cid, payload)
+
+threading.Thread(target=beat, daemon=True).start()
+struct.pack_into("<I", buf, 24, 1)
+idle = 0
+while not stopping():
+    msg = read()
+    if msg is None:
+        idle += 1
+        time.sleep(0.0001 if idle < 1000 else 0.002)
+        continue
+    idle = 0
+    kind, cid, data = msg
+    if kind == 6:
+        seg = held.pop(data.decode(), None)
+        if seg is not None:
+            seg.close()
+            seg.unlink()
+        continue
+    try:
+        run(kind, cid, data)
+    except BaseException:
+        write(4, cid, traceback.format_exc().encode()[-(ring // 8):])
+for seg in held.values():
+    seg.close()
+    seg.unlink()
+shm.close()
+)";
+
+class PySharedMemory
+{
+private:
+	String m_name;
+	uint8_t* m_ptr = NULL;
+	uint64_t m_size = 0;
+	bool m_owner = false;
+#ifdef WINDOWS_ENABLED
+	HANDLE m_handle = NULL;
+#endif
+
+	Error map(const String& p_name, uint64_t p_size, bool p_create);
+
+public:
+	Error create(const String& p_name, uint64_t p_size) { return map(p_name, p_size, true); }
+	Error open(const String& p_name, uint64_t p_size) { return map(p_name, p_size, false); }
+	void close();
+	// Removes a segment another process created. Windows frees it with its last handle.
+	static void remove(const String& p_name);
+	uint8_t* ptr() const { return m_ptr; }
+	uint64_t size() const { return m_size; }
+
+	~PySharedMemory() { close(); }
+};
+
+#ifdef WINDOWS_ENABLED
+Error PySharedMemory::map(const String& p_name, uint64_t p_size, bool p_create)
+{
+	close();
+	if (p_create)
+		m_handle = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)(p_size >> 32), (DWORD)p_size, (LPCWSTR)p_name.c_str());
+	else
+		m_handle = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, (LPCWSTR)p_name.c_str());
+	if (!m_handle)
+		return p_create ? ERR_CANT_CREATE : ERR_CANT_OPEN;
+
+	m_ptr = (uint8_t*)MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, p_size);
+	if (!m_ptr)
+	{
+		CloseHandle(m_handle);
+		m_handle = NULL;
+		return p_create ? ERR_CANT_CREATE : ERR_CANT_OPEN;
+	}
+	m_name = p_name;
+	m_size = p_size;
+	m_owner = p_create;
+	return OK;
+}
+
+void PySharedMemory::close()
+{
+	if (m_ptr)
+		UnmapViewOfFile(m_ptr);
+	if (m_handle)
+		CloseHandle(m_handle);
+	m_ptr = NULL;
+	m_handle = NULL;
+	m_size = 0;
+}
+
+void PySharedMemory::remove(const String& p_name)
+{
+}
+#else
+Error PySharedMemory::map(const String& p_name, uint64_t p_size, bool p_create)
+{
+	close();
+	CharString path = ("/" + p_name).utf8();
+	int fd = shm_open(path.get_data(), p_create ? O_CREAT | O_EXCL | O_RDWR : O_RDWR, 0600);
+	if (fd < 0)
+		return p_create ? ERR_CANT_CREATE : ERR_CANT_OPEN;
+	if (p_create && ftruncate(fd, p_size) != 0)
+	{
+		::close(fd);
+		shm_unlink(path.get_data());
+		return ERR_CANT_CREATE;
+	}
+
+	void* ptr = mmap(NULL, p_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (ptr == MAP_FAILED)
+	{
+		if (p_create)
+			shm_unlink(path.get_data());
+		return p_create ? ERR_CANT_CREATE : ERR_CANT_OPEN;
+	}
+	m_ptr = (uint8_t*)ptr;
+	m_name = p_name;
+	m_size = p_size;
+	m_owner = p_create;
+	return OK;
+}
+
+void PySharedMemory::close()
+{
+	if (m_ptr)
+	{
+		munmap(m_ptr, m_size);
+		if (m_owner)
+			shm_unlink(("/" + m_name).utf8().get_data());
+	}
+	m_ptr = NULL;
+	m_size = 0;
+}
+
+void PySharedMemory::remove(const String& p_name)
+{
+	shm_unlink(("/" + p_name).utf8().get_data());
+}
+#endif
+
+// True once p_pid has exited; with p_wait, blocks until it has. On POSIX this also
+// reaps it, so it leaves no zombie and its pid can't be reused under us.
+static bool process_reap(OS::ProcessID p_pid, bool p_wait)
+{
+#ifdef WINDOWS_ENABLED
+	HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)p_pid);
+	if (!process)
+		return true;
+	bool exited = WaitForSingleObject(process, p_wait ? INFINITE : 0) == WAIT_OBJECT_0;
+	CloseHandle(process);
+	return exited;
+#else
+	pid_t ret = waitpid((pid_t)p_pid, NULL, p_wait ? 0 : WNOHANG);
+	return ret == (pid_t)p_pid || (ret < 0 && errno == ECHILD);
+#endif
+}
+
+static inline volatile uint64_t* shm_u64(uint8_t* p_base, int p_offset)
+{
+	return (volatile uint64_t*)(p_base + p_offset);
+}
+
+static void ring_put(uint8_t* p_ring, uint64_t p_size, uint64_t p_pos, const uint8_t* p_data, uint64_t p_len)
+{
+	uint64_t start = p_pos % p_size;
+	uint64_t first = MIN(p_len, p_size - start);
+	memcpy(p_ring + start, p_data, first);
+	if (first < p_len)
+		memcpy(p_ring, p_data + first, p_len - first);
+}
+
+static void ring_get(const uint8_t* p_ring, uint64_t p_size, uint64_t p_pos, uint8_t* r_data, uint64_t p_len)
+{
+	uint64_t start = p_pos % p_size;
+	uint64_t first = MIN(p_len, p_size - start);
+	memcpy(r_data, p_ring + start, first);
+	if (first < p_len)
+		memcpy(r_data + first, p_ring, p_len - first);
+}
+
+// Messages are [u32 length][u32 kind][u64 call id][payload], padded to 8 bytes.
+static bool ring_write(uint8_t* p_shm, uint32_t p_kind, uint64_t p_id, const uint8_t* p_data, uint32_t p_len)
+{
+	uint64_t size = *shm_u64(p_shm, WORKER_OFF_RING);
+	uint8_t* ring = p_shm + WORKER_HEADER_SIZE;
+	volatile uint64_t* head = shm_u64(p_shm, WORKER_OFF_REQ_HEAD);
+	uint64_t h = *head;
+	uint64_t t = *shm_u64(p_shm, WORKER_OFF_REQ_TAIL);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t total = (16 + p_len + 7) & ~7ULL;
+	if (size - (h - t) < total)
+		return false;
+
+	uint8_t header[16];
+	encode_uint32(p_len, header);
+	encode_uint32(p_kind, header + 4);
+	encode_uint64(p_id, header + 8);
+	ring_put(ring, size, h, header, 16);
+	ring_put(ring, size, h + 16, p_data, p_len);
+	std::atomic_thread_fence(std::memory_order_release);
+	*head = h + total;
+	return true;
+}
+
+static bool ring_read(uint8_t* p_shm, uint32_t& r_kind, uint64_t& r_id, Vector<uint8_t>& r_data)
+{
+	uint64_t size = *shm_u64(p_shm, WORKER_OFF_RING);
+	uint8_t* ring = p_shm + WORKER_HEADER_SIZE + size;
+	volatile uint64_t* tail = shm_u64(p_shm, WORKER_OFF_RESP_TAIL);
+	uint64_t h = *shm_u64(p_shm, WORKER_OFF_RESP_HEAD);
+	uint64_t t = *tail;
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (h == t)
+		return false;
+
+	uint8_t header[16];
+	ring_get(ring, size, t, header, 16);
+	uint32_t len = decode_uint32(header);
+	r_kind = decode_uint32(header + 4);
+	r_id = decode_uint64(header + 8);
+	r_data.resize(len);
+	ring_get(ring, size, t + 16, r_data.ptrw(), len);
+	std::atomic_thread_fence(std::memory_order_release);
+	*tail = t + ((16 + len + 7) & ~7ULL);
+	return true;
+}
+
+static Variant unmarshal(const uint8_t* p_data, Py_ssize_t p_len, String& r_error)
+{
+	PyObject* obj = PyMarshal_ReadObjectFromString((const char*)p_data, p_len);
+	if (!obj)
+	{
+		PyErr_Clear();
+		r_error = "Can't unmarshal the worker result.";
+		return Variant();
+	}
+	Variant ret = PyScript::py2gd(obj);
+	Py_DECREF(obj);
+	return ret;
+}
+
+String PyWorkerPool::segment_name()
+{
+	return "pw" + itos(OS::get_singleton()->get_process_id()) + "_" + itos(m_nextSegment++);
+}
+
+Error PyWorkerPool::launch(int p_index)
+{
+	Worker* w = m_workers[p_index];
+	if (w->shm)
+		memdelete(w->shm);
+	w->shm = memnew(PySharedMemory);
+	w->heartbeat = 0;
+	w->heartbeatTicks = OS::get_singleton()->get_ticks_usec();
+	w->inFlight = 0;
+
+	String name = segment_name();
+	Error err = w->shm->create(name, WORKER_HEADER_SIZE + 2 * (uint64_t)m_ringSize);
+	if (err != OK)
+	{
+		memdelete(w->shm);
+		w->shm = NULL;
+		ERR_FAIL_V_MSG(err, "Can't create the worker shared memory.");
+	}
+	encode_uint32(WORKER_MAGIC, w->shm->ptr());
+	*shm_u64(w->shm->ptr(), WORKER_OFF_RING) = m_ringSize;
+
+	List<String> args;
+	args.push_back(m_scriptPath);
+	args.push_back(name);
+	PyObject* path = PySys_GetObject("path");
+	if (path && PyList_Check(path))
+	{
+		for (Py_ssize_t i = 0; i < PyList_GET_SIZE(path); ++i)
+		{
+			PyObject* item = PyList_GET_ITEM(path, i);
+			if (PyUnicode_Check(item))
+				args.push_back(PyScript::py2gd(item));
+		}
+	}
+	err = OS::get_singleton()->execute(m_executable, args, false, &w->pid);
+	if (err != OK)
+	{
+		w->pid = 0;
+		memdelete(w->shm);
+		w->shm = NULL;
+	}
+	return err;
+}
+
+// Kills the worker's process if it still runs and waits for it, then drops its segment
+// and whatever result segments it was never told to release.
+void PyWorkerPool::kill_worker(Worker* p_worker)
+{
+	if (p_worker->pid)
+	{
+		if (!process_reap(p_worker->pid, false))
+		{
+			OS::get_singleton()->kill(p_worker->pid);
+			process_reap(p_worker->pid, true);
+		}
+		p_worker->pid = 0;
+	}
+	for (auto E = p_worker->releases.front(); E; E = E->next())
+	{
+		PySharedMemory::remove(E->get());
+	}
+	p_worker->releases.clear();
+	if (p_worker->shm)
+		memdelete(p_worker->shm);
+	p_worker->shm = NULL;
+}
+
+Error PyWorkerPool::start(int p_count, const String& p_executable, int p_ringSize)
+{
+	ERR_FAIL_COND_V_MSG(is_running(), ERR_ALREADY_IN_USE, "Python workers are already running.");
+	ERR_FAIL_COND_V(p_count <= 0, ERR_INVALID_PARAMETER);
+
+	m_executable = p_executable;
+	m_ringSize = (MAX(p_ringSize, 4096) + 7) & ~7;
+	m_scriptPath = OS::get_singleton()->get_user_data_dir().plus_file("pyscript_worker.py");
+	FileAccess* f = FileAccess::open(m_scriptPath, FileAccess::WRITE);
+	ERR_FAIL_COND_V(!f, ERR_CANT_CREATE);
+	f->store_string(WORKER_SCRIPT);
+	f->close();
+	memdelete(f);
+
+	for (int i = 0; i < p_count; ++i)
+	{
+		m_workers.push_back(memnew(Worker));
+		Error err = launch(i);
+		if (err != OK)
+		{
+			stop();
+			return err;
+		}
+	}
+	return OK;
+}
+
+void PyWorkerPool::stop()
+{
+	if (m_workers.empty())
+		return;
+
+	for (int i = 0; i < m_workers.size(); ++i)
+	{
+		if (m_workers[i]->shm)
+			encode_uint32(WORKER_STATE_STOP, m_workers[i]->shm->ptr() + WORKER_OFF_STATE);
+	}
+	// Idle workers notice the stop flag within a few milliseconds; busy ones are killed
+	// once WORKER_STOP_USEC has passed.
+	OS* os = OS::get_singleton();
+	uint64_t start = os->get_ticks_usec();
+	while (true)
+	{
+		bool running = false;
+		for (int i = 0; i < m_workers.size(); ++i)
+		{
+			Worker* w = m_workers[i];
+			if (w->pid && process_reap(w->pid, false))
+				w->pid = 0;
+			running = running || w->pid;
+		}
+		if (!running || os->get_ticks_usec() - start >= WORKER_STOP_USEC)
+			break;
+		os->delay_usec(1000);
+	}
+
+	while (!m_pending.empty())
+	{
+		finish_call(m_pending.front()->key(), Variant(), "Python workers stopped.");
+	}
+	for (int i = 0; i < m_workers.size(); ++i)
+	{
+		kill_worker(m_workers[i]);
+		memdelete(m_workers[i]);
+	}
+	m_workers.clear();
+}
+
+void PyWorkerPool::fail_worker(int p_index, const String& p_error)
+{
+	Worker* w = m_workers[p_index];
+	ERR_PRINT(p_error);
+	kill_worker(w);
+
+	List<int> ids;
+	for (auto E = m_pending.front(); E; E = E->next())
+	{
+		if (E->get() == p_index)
+			ids.push_back(E->key());
+	}
+	for (auto E = ids.front(); E; E = E->next())
+	{
+		finish_call(E->get(), Variant(), p_error);
+	}
+	schedule_restart(w);
+}
+
+void PyWorkerPool::schedule_restart(Worker* p_worker)
+{
+	// A worker that got as far as a heartbeat was healthy; restart it right away.
+	if (p_worker->heartbeat != 0)
+		p_worker->restarts = 0;
+	p_worker->restartTicks = 0;
+	if (p_worker->restarts >= WORKER_MAX_RESTARTS)
+	{
+		ERR_PRINT("Python worker failed to start " + itos(p_worker->restarts) + " times in a row; it won't be restarted.");
+		return;
+	}
+	uint64_t delay = p_worker->restarts == 0 ? 0 : (uint64_t)WORKER_RESTART_USEC << (p_worker->restarts - 1);
+	p_worker->restartTicks = OS::get_singleton()->get_ticks_usec() + delay;
+	p_worker->restarts++;
+}
+
+void PyWorkerPool::finish_call(int p_id, const Variant& p_value, const String& p_error)
+{
+	auto E = m_pending.find(p_id);
+	if (!E)
+		return;
+	m_workers[E->get()]->inFlight--;
+	m_pending.erase(E);
+
+	auto S = m_callSegments.find(p_id);
+	if (S)
+	{
+		memdelete(S->get());
+		m_callSegments.erase(S);
+	}
+
+	Result r;
+	r.value = p_value;
+	r.error = p_error;
+	m_results[p_id] = r;
+	m_completed.push_back(p_id);
+}
+
+void PyWorkerPool::read_responses(int p_index)
+{
+	Worker* w = m_workers[p_index];
+	uint32_t kind;
+	uint64_t id;
+	Vector<uint8_t> data;
+	// Releases that didn't fit in the request ring last time go first.
+	while (w->shm && !w->releases.empty())
+	{
+		CharString name = w->releases.front()->get().utf8();
+		if (!ring_write(w->shm->ptr(), KIND_RELEASE, 0, (const uint8_t*)name.get_data(), name.length()))
+			break;
+		w->releases.pop_front();
+	}
+	while (w->shm && ring_read(w->shm->ptr(), kind, id, data))
+	{
+		String error;
+		Variant value;
+		switch (kind)
+		{
+		case KIND_RESULT:
+			value = unmarshal(data.ptr(), data.size(), error);
+			break;
+		case KIND_ERROR:
+			error.parse_utf8((const char*)data.ptr(), data.size());
+			break;
+		case KIND_RESULT_SHM:
+		{
+			uint64_t size = decode_uint64(data.ptr());
+			String name;
+			name.parse_utf8((const char*)data.ptr() + 8, data.size() - 8);
+			PySharedMemory seg;
+			if (seg.open(name, size) == OK)
+				value = unmarshal(seg.ptr(), size, error);
+			else
+				error = "Can't open the worker result segment.";
+			seg.close();
+			CharString nameUtf8 = name.utf8();
+			if (!w->releases.empty() || !ring_write(w->shm->ptr(), KIND_RELEASE, id, (const uint8_t*)nameUtf8.get_data(), nameUtf8.length()))
+				w->releases.push_back(name);
+		} break;
+		default:
+			error = "Unknown worker message.";
+		}
+		finish_call(id, value, error);
+	}
+}
+
+int PyWorkerPool::submit(const String& p_module, const String& p_function, const Array& p_args)
+{
+	ERR_FAIL_COND_V_MSG(!is_running(), -1, "Python workers are not started.");
+
+	Variant args = p_args;
+	// "N" steals the tuple.
+	PyObject* tuple = PyScript::gd2py_owned(args, true);
+	PyObject* call = Py_BuildValue("(ssN)", p_module.utf8().get_data(), p_function.utf8().get_data(), tuple);
+	PyObject* data = call ? PyMarshal_WriteObjectToString(call, Py_MARSHAL_VERSION) : NULL;
+	Py_XDECREF(call);
+	if (!data)
+	{
+		PyErr_Print();
+		return -1;
+	}
+
+	int index = -1;
+	for (int i = 0; i < m_workers.size(); ++i)
+	{
+		if (m_workers[i]->shm && (index < 0 || m_workers[i]->inFlight < m_workers[index]->inFlight))
+			index = i;
+	}
+	if (index < 0)
+	{
+		Py_DECREF(data);
+		ERR_FAIL_V_MSG(-1, "No Python worker is running.");
+	}
+	Worker* w = m_workers[index];
+	int id = m_nextId++;
+	char* bytes;
+	Py_ssize_t len;
+	PyBytes_AsStringAndSize(data, &bytes, &len);
+
+	bool ok = false;
+	if (len > m_ringSize / 4)
+	{
+		PySharedMemory* seg = memnew(PySharedMemory);
+		String segName = segment_name();
+		if (seg->create(segName, len) == OK)
+		{
+			memcpy(seg->ptr(), bytes, len);
+			CharString nameUtf8 = segName.utf8();
+			Vector<uint8_t> msg;
+			msg.resize(8 + nameUtf8.length());
+			encode_uint64(len, msg.ptrw());
+			memcpy(msg.ptrw() + 8, nameUtf8.get_data(), nameUtf8.length());
+			ok = ring_write(w->shm->ptr(), KIND_CALL_SHM, id, msg.ptr(), msg.size());
+		}
+		if (ok)
+			m_callSegments[id] = seg;
+		else
+			memdelete(seg);
+	}
+	else
+	{
+		ok = ring_write(w->shm->ptr(), KIND_CALL, id, (const uint8_t*)bytes, len);
+	}
+	Py_DECREF(data);
+	ERR_FAIL_COND_V_MSG(!ok, -1, "Python worker request queue is full.");
+
+	m_pending[id] = index;
+	w->inFlight++;
+	return id;
+}
+
+void PyWorkerPool::poll()
+{
+	uint64_t now = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < m_workers.size(); ++i)
+	{
+		Worker* w = m_workers[i];
+		if (!w->shm)
+		{
+			if (w->restartTicks && now >= w->restartTicks && launch(i) != OK)
+				schedule_restart(w);
+			continue;
+		}
+
+		uint64_t beat = *shm_u64(w->shm->ptr(), WORKER_OFF_HEARTBEAT);
+		if (beat != w->heartbeat)
+		{
+			w->heartbeat = beat;
+			w->heartbeatTicks = now;
+		}
+		read_responses(i);
+		// A crash shows up here at once instead of after the heartbeat timeout.
+		if (w->pid && process_reap(w->pid, false))
+		{
+			w->pid = 0;
+			fail_worker(i, "Python worker exited.");
+		}
+		else if (now - w->heartbeatTicks > m_timeoutUsec)
+		{
+			fail_worker(i, "Python worker stopped responding.");
+		}
+	}
+}
+
+bool PyWorkerPool::take_result(int p_id, Variant& r_value, String& r_error)
+{
+	auto E = m_results.find(p_id);
+	if (!E)
+		return false;
+	r_value = E->get().value;
+	r_error = E->get().error;
+	m_results.erase(E);
+	return true;
+}
+
+// The result stays claimable by take_result() until WORKER_KEEP_DELIVERED newer ones
+// have been delivered.
+bool PyWorkerPool::take_completed(int& r_id, Variant& r_value, String& r_error)
+{
+	while (!m_completed.empty())
+	{
+		r_id = m_completed.front()->get();
+		m_completed.pop_front();
+		auto E = m_results.find(r_id);
+		if (!E)
+			continue;
+		r_value = E->get().value;
+		r_error = E->get().error;
+		m_delivered.push_back(r_id);
+		if (m_delivered.size() > WORKER_KEEP_DELIVERED)
+		{
+			m_results.erase(m_delivered.front()->get());
+			m_delivered.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
+
+PyWorkerPool::~PyWorkerPool()
+{
+	stop();
+}
@@ -0,0 +1,81 @@
+#ifndef PY_WORKER_H
+#define PY_WORKER_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/array.h"
+#include "core/list.h"
+#include "core/map.h"
+#include "core/os/os.h"
+#include "core/variant.h"
+#include "core/vector.h"
+
+class PySharedMemory;
+
+// Runs Python calls in separate interpreter processes. Each worker owns one shared-memory
+// segment with a request and a response ring; payloads are marshal data, and payloads
+// larger than a quarter ring travel in their own segment. A worker that stops updating
+// its heartbeat is killed and restarted, and its in-flight calls fail; one that keeps
+// dying before its first heartbeat is restarted with a growing delay, then given up on.
+class PyWorkerPool
+{
+private:
+	typedef struct Worker {
+		PySharedMemory* shm = NULL;
+		OS::ProcessID pid = 0;
+		uint64_t heartbeat = 0;
+		uint64_t heartbeatTicks = 0;
+		int inFlight = 0;
+		// Failed starts in a row, and when to try again (0: not waiting to restart).
+		int restarts = 0;
+		uint64_t restartTicks = 0;
+		// Result segments whose KIND_RELEASE didn't fit in the request ring yet.
+		List<String> releases;
+	}Worker;
+
+	typedef struct Result {
+		Variant value;
+		String error;
+	}Result;
+
+	Vector<Worker*> m_workers;
+	String m_executable;
+	String m_scriptPath;
+	int m_ringSize = 0;
+	uint64_t m_timeoutUsec = 10000000;
+	int m_nextId = 1;
+	int m_nextSegment = 0;
+	Map<int, int> m_pending;
+	Map<int, PySharedMemory*> m_callSegments;
+	Map<int, Result> m_results;
+	List<int> m_completed;
+	List<int> m_delivered;
+
+	String segment_name();
+	Error launch(int p_index);
+	void kill_worker(Worker* p_worker);
+	void fail_worker(int p_index, const String& p_error);
+	void schedule_restart(Worker* p_worker);
+	void finish_call(int p_id, const Variant& p_value, const String& p_error);
+	void read_responses(int p_index);
+
+public:
+	Error start(int p_count, const String& p_executable, int p_ringSize);
+	void stop();
+	bool is_running() const { return !m_workers.empty(); }
+	int get_worker_count() const { return m_workers.size(); }
+	void set_timeout(uint64_t p_usec) { m_timeoutUsec = p_usec; }
+	uint64_t get_timeout() const { return m_timeoutUsec; }
+
+	int submit(const String& p_module, const String& p_function, const Array& p_args);
+	void poll();
+	bool has_result(int p_id) const { return m_results.has(p_id); }
+	bool is_pending(int p_id) const { return m_pending.has(p_id); }
+	bool was_submitted(int p_id) const { return p_id > 0 && p_id < m_nextId; }
+	bool take_result(int p_id, Variant& r_value, String& r_error);
+	bool take_completed(int& r_id, Variant& r_value, String& r_error);
+
+	~PyWorkerPool();
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "py_wrapper_pool.h"
+#include "pyscript.h"
+
+PyWrapperPool& PyWrapperPool::get()
+{
+	static PyWrapperPool pool;
+	return pool;
+}
+
+Variant PyWrapperPool::wrap(PyObject* p_obj)
+{
+	destroy_excess();
+
+	++m_acquires;
+	PyScriptInstance* inst = m_free;
+	if (inst)
+	{
+		m_free = inst->m_nextFree;
+		inst->m_nextFree = NULL;
+		--m_freeCount;
+		++m_hits;
+	}
+	else
+	{
+		inst = memnew(PyScriptInstance);
+		Reference* owner = memnew(Reference);
+		inst->m_owner = owner;
+		inst->m_script = Ref<PyScript>(memnew(PyScript));
+		owner->set_script_instance(inst);
+		if (m_capacity > 0)
+		{
+			// The pool's own reference; see refcount_decremented().
+			owner->init_ref();
+			inst->m_pooled = true;
+		}
+	}
+
+	// The owner holds the script too, so 2 means nobody outside kept it.
+	if (inst->m_pooled && inst->m_script->reference_get_count() > 2)
+	{
+		destroy(inst);
+		--m_hits;
+		--m_acquires;
+		return wrap(p_obj);
+	}
+
+	PyObject* tp = PyObject_Type(p_obj);
+	inst->m_script->set_module(tp);
+	Py_XDECREF(tp);
+	inst->m_script->m_introspection = PyScript::Introspection();
+	inst->m_introspection = PyScript::Introspection();
+	Py_INCREF(p_obj);
+	inst->m_obj = p_obj;
+
+	if (inst->m_pooled)
+	{
+		++m_inUse;
+		if (m_inUse > m_highWater)
+			m_highWater = m_inUse;
+	}
+	return REF(Object::cast_to<Reference>(inst->m_owner));
+}
+
+// Drops what GDScript may have attached to a wrapper, so the next object doesn't inherit
+// it. Its instance id stays, and so do WeakRefs pointing at it.
+static void reset_owner(Object* p_owner)
+{
+	List<Object::Connection> connections;
+	p_owner->get_all_signal_connections(&connections);
+	p_owner->get_signals_connected_to_this(&connections);
+	for (auto E = connections.front(); E; E = E->next())
+	{
+		const Object::Connection& c = E->get();
+		if (c.source && c.target && c.source->is_connected(c.signal, c.target, c.method))
+			c.source->disconnect(c.signal, c.target, c.method);
+	}
+
+	List<String> meta;
+	p_owner->get_meta_list(&meta);
+	for (auto E = meta.front(); E; E = E->next())
+	{
+		p_owner->remove_meta(E->get());
+	}
+}
+
+void PyWrapperPool::release(PyScriptInstance* p_inst)
+{
+	// May run Python code (__del__) that wraps other objects, so do it before relinking.
+	p_inst->free();
+	p_inst->m_introspection = PyScript::Introspection();
+	--m_inUse;
+	reset_owner(p_inst->m_owner);
+
+	if (m_freeCount < m_capacity)
+	{
+		p_inst->m_nextFree = m_free;
+		m_free = p_inst;
+		++m_freeCount;
+	}
+	else
+	{
+		p_inst->m_nextFree = m_excess;
+		m_excess = p_inst;
+	}
+}
+
+void PyWrapperPool::destroy(PyScriptInstance* p_inst)
+{
+	Reference* owner = Object::cast_to<Reference>(p_inst->m_owner);
+	// Drops the pool's reference; the owner deletes its script instance with it.
+	if (owner->unreference())
+		memdelete(owner);
+}
+
+void PyWrapperPool::destroy_excess()
+{
+	while (m_excess)
+	{
+		PyScriptInstance* inst = m_excess;
+		m_excess = inst->m_nextFree;
+		destroy(inst);
+	}
+}
+
+void PyWrapperPool::trim(int p_keep)
+{
+	destroy_excess();
+	while (m_free && m_freeCount > p_keep)
+	{
+		PyScriptInstance* inst = m_free;
+		m_free = inst->m_nextFree;
+		--m_freeCount;
+		destroy(inst);
+	}
+}
+
+void PyWrapperPool::clear()
+{
+	trim(0);
+}
+
+void PyWrapperPool::set_capacity(int p_capacity)
+{
+	m_capacity = MAX(p_capacity, 0);
+	trim(m_capacity);
+}
+
+Dictionary PyWrapperPool::get_stats() const
+{
+	Dictionary ret;
+	ret["acquires"] = m_acquires;
+	ret["hits"] = m_hits;
+	ret["hit_rate"] = m_acquires ? (double)m_hits / m_acquires : 0.0;
+	ret["in_use"] = m_inUse;
+	ret["high_water"] = m_highWater;
+	ret["free"] = m_freeCount;
+	ret["capacity"] = m_capacity;
+	return ret;
+}
@@ -0,0 +1,47 @@
+#ifndef PY_WRAPPER_POOL_H
+#define PY_WRAPPER_POOL_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "core/dictionary.h"
+#include "core/variant.h"
+
+class PyScriptInstance;
+
+// Recycles the Reference + PyScriptInstance + PyScript wrappers py2gd builds around
+// plain Python objects. The pool keeps one reference on every owner it made, so an
+// owner never reaches zero while pooled: when the last outside reference goes,
+// PyScriptInstance::refcount_decremented() hands the pair back here instead.
+// Pairs that don't fit in the free list are destroyed on the next wrap() or trim(),
+// because the pair being released is still inside Reference::unreference().
+class PyWrapperPool
+{
+private:
+	PyScriptInstance* m_free = NULL;
+	PyScriptInstance* m_excess = NULL;
+	int m_freeCount = 0;
+	// Off until asked for: a pooled wrapper keeps its instance id for the next object.
+	int m_capacity = 0;
+	int m_inUse = 0;
+	int m_highWater = 0;
+	uint64_t m_acquires = 0;
+	uint64_t m_hits = 0;
+
+	void destroy(PyScriptInstance* p_inst);
+	void destroy_excess();
+
+public:
+	static PyWrapperPool& get();
+
+	Variant wrap(PyObject* p_obj);
+	void release(PyScriptInstance* p_inst);
+	void trim(int p_keep);
+	void clear();
+
+	// 0 (the default) turns pooling off for new wrappers.
+	void set_capacity(int p_capacity);
+	int get_capacity() const { return m_capacity; }
+	Dictionary get_stats() const;
+};
+
+#endif
@@ -1,7 +1,19 @@
 #include "pyscript.h"
 #include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/set.h"
+#include "py_arena.h"
+#include "py_codec.h"
+#include "py_columns.h"
+#include "py_imports.h"
+#include "py_memo.h"
+#include "py_memory.h"
+#include "py_names.h"
+#include "py_object.h"
+#include "scene/main/scene_tree.h"
 
 Python* Python::singleton = NULL;
+SelfList<PyScript>::List PyScript::script_list;
 
 
 inline Ref<PyScript> Python::cast_to_script(const Variant& p_obj)
@@ -146,6 +158,185 @@ Variant Python::next(const Variant& p_iter, const Variant& p_default)
 	return p_default;
 }
 
+// Reads every name in one pass, through the interned names of the name cache. Missing
+// attributes come back as null.
+Variant Python::get_attrs(const Variant& p_obj, const PoolStringArray& p_names, bool p_asArray)
+{
+	PyObject* obj = PyScript::gd2py(p_obj);
+	if (obj == Py_None)
+		ERR_FAIL_V_MSG(Variant(), "get_attrs() needs a Python object.");
+
+	int count = p_names.size();
+	PoolStringArray::Read names = p_names.read();
+	Dictionary dict;
+	Array array;
+	if (p_asArray)
+		array.resize(count);
+	PyNameCache& cache = PyNameCache::get();
+	for (int i = 0; i < count; ++i)
+	{
+		StringName name = names[i];
+		PyObject* attr = cache.get_attr(obj, name);
+		Variant value;
+		if (attr)
+		{
+			value = PyScript::py2gd(attr);
+			Py_DECREF(attr);
+		}
+		else
+		{
+			PyErr_Clear();
+		}
+		if (p_asArray)
+			array[i] = value;
+		else
+			dict[names[i]] = value;
+	}
+	Py_DECREF(obj);
+	if (p_asArray)
+		return array;
+	return dict;
+}
+
+// Returns the number of attributes set; the keys that fail are reported and skipped.
+int Python::set_attrs(const Variant& p_obj, const Dictionary& p_values)
+{
+	PyObject* obj = PyScript::gd2py(p_obj);
+	if (obj == Py_None)
+		ERR_FAIL_V_MSG(0, "set_attrs() needs a Python object.");
+
+	int count = 0;
+	PyNameCache& cache = PyNameCache::get();
+	for (const Variant* key = p_values.next(NULL); key; key = p_values.next(key))
+	{
+		PyObject* value = PyScript::gd2py(p_values.getptr(*key));
+		if (cache.set_attr(obj, String(*key), value) == 0)
+			++count;
+		else
+			PyErr_Print();
+		if (value != Py_None)
+			Py_XDECREF(value);
+	}
+	Py_DECREF(obj);
+	return count;
+}
+
+// A new reference to p_obj's Python object, or to its attribute p_attr when one is given,
+// so a container held by an instance can be indexed without converting it. NULL if neither exists.
+static PyObject* item_target(const Variant& p_obj, const String& p_attr)
+{
+	PyObject* obj = PyScript::gd2py(p_obj);
+	if (obj == Py_None)
+		return NULL;
+	if (p_attr == "")
+		return obj;
+
+	PyObject* attr = PyNameCache::get().get_attr(obj, p_attr);
+	Py_DECREF(obj);
+	if (!attr)
+		PyErr_Print();
+	return attr;
+}
+
+// Item access on the live object; only the element that is read gets converted.
+Variant Python::getitem(const Variant& p_obj, const Variant& p_key, const String& p_attr)
+{
+	PyObject* obj = item_target(p_obj, p_attr);
+	if (!obj)
+		ERR_FAIL_V_MSG(Variant(), "getitem() needs a Python object.");
+
+	PyObject* key = PyScript::gd2py(&p_key, true);
+	PyObject* item = PyObject_GetItem(obj, key);
+	if (key != Py_None)
+		Py_XDECREF(key);
+	Py_DECREF(obj);
+	if (!item)
+	{
+		PyErr_Print();
+		return Variant();
+	}
+	Variant ret = PyScript::py2gd(item);
+	Py_DECREF(item);
+	return ret;
+}
+
+bool Python::setitem(const Variant& p_obj, const Variant& p_key, const Variant& p_value, const String& p_attr)
+{
+	PyObject* obj = item_target(p_obj, p_attr);
+	if (!obj)
+		ERR_FAIL_V_MSG(false, "setitem() needs a Python object.");
+
+	PyObject* key = PyScript::gd2py(&p_key, true);
+	PyObject* value = PyScript::gd2py(p_value);
+	bool ret = PyObject_SetItem(obj, key, value) == 0;
+	if (!ret)
+		PyErr_Print();
+	if (key != Py_None)
+		Py_XDECREF(key);
+	if (value != Py_None)
+		Py_XDECREF(value);
+	Py_DECREF(obj);
+	return ret;
+}
+
+// obj[start:stop:step]; a null bound is left open like an omitted one in Python.
+Variant Python::slice(const Variant& p_obj, const Variant& p_start, const Variant& p_stop, const Variant& p_step, const String& p_attr)
+{
+	PyObject* obj = item_target(p_obj, p_attr);
+	if (!obj)
+		ERR_FAIL_V_MSG(Variant(), "slice() needs a Python object.");
+
+	PyObject* start = PyScript::gd2py(p_start);
+	PyObject* stop = PyScript::gd2py(p_stop);
+	PyObject* step = PyScript::gd2py(p_step);
+	PyObject* range = PySlice_New(start, stop, step);
+	PyObject* item = range ? PyObject_GetItem(obj, range) : NULL;
+	Py_XDECREF(range);
+	if (start != Py_None)
+		Py_XDECREF(start);
+	if (stop != Py_None)
+		Py_XDECREF(stop);
+	if (step != Py_None)
+		Py_XDECREF(step);
+	Py_DECREF(obj);
+	if (!item)
+	{
+		PyErr_Print();
+		return Variant();
+	}
+	Variant ret = PyScript::py2gd(item);
+	Py_DECREF(item);
+	return ret;
+}
+
+// -1 when the object has no length.
+int64_t Python::len(const Variant& p_obj, const String& p_attr)
+{
+	PyObject* obj = item_target(p_obj, p_attr);
+	if (!obj)
+		ERR_FAIL_V_MSG(-1, "len() needs a Python object.");
+
+	Py_ssize_t ret = PyObject_Length(obj);
+	if (ret < 0)
+		PyErr_Clear();
+	Py_DECREF(obj);
+	return ret;
+}
+
+// Records to Pool array columns; see columns_from_records.
+Dictionary Python::to_columns(const Variant& p_obj, const Dictionary& p_schema, const String& p_attr)
+{
+	PyObject* obj = item_target(p_obj, p_attr);
+	if (!obj)
+		ERR_FAIL_V_MSG(Dictionary(), "to_columns() needs a Python object.");
+
+	Dictionary ret;
+	if (!columns_from_records(obj, p_schema, ret))
+		PyErr_Print();
+	Py_DECREF(obj);
+	return ret;
+}
+
 bool Python::run_file(String p_path, Vector<String> p_argv)
 {
 	FileAccess* f = FileAccess::open(p_path, FileAccess::READ);
@@ -187,12 +378,738 @@ bool Python::run_file(String p_path, Vector<String> p_argv)
 	PySys_SetArgv(argc, wargv);
 	bool ret = PyRun_SimpleString(s.utf8().get_data());
 
-	/*for (int i = 0; i < argc; ++i)
-	{
-		PyMem_RawFree(wargv[i]);
-		wargv[i] = nullptr;
-	}*/
-	delete[] wargv;
+	/*for (int i = 0; i < argc; ++i)
+	{
+		PyMem_RawFree(wargv[i]);
+		wargv[i] = nullptr;
+	}*/
+	delete[] wargv;
+	return ret;
+}
+
+void Python::set_typed_list_threshold(int p_threshold)
+{
+	m_typedListThreshold = p_threshold;
+}
+
+int Python::get_typed_list_threshold() const
+{
+	return m_typedListThreshold;
+}
+
+void Python::set_hot_reload(bool p_enabled)
+{
+	if (m_hotReload == p_enabled)
+		return;
+
+	SceneTree* tree = SceneTree::get_singleton();
+	ERR_FAIL_COND_MSG(!tree, "Hot reload needs a running SceneTree.");
+	m_hotReload = p_enabled;
+	if (p_enabled)
+		tree->connect("idle_frame", this, "_hot_reload_step");
+	else
+		tree->disconnect("idle_frame", this, "_hot_reload_step");
+}
+
+bool Python::is_hot_reload() const
+{
+	return m_hotReload;
+}
+
+void Python::set_hot_reload_budget(int p_usec)
+{
+	m_hotReloadBudget = MAX(p_usec, 1);
+}
+
+int Python::get_hot_reload_budget() const
+{
+	return m_hotReloadBudget;
+}
+
+int Python::reload_changed()
+{
+	return m_reloader.reload_changed();
+}
+
+void Python::_hot_reload_step()
+{
+	m_reloader.step(m_hotReloadBudget);
+}
+
+void Python::set_bulk_conversion(bool p_enabled)
+{
+	m_bulkConversion = p_enabled;
+}
+
+bool Python::is_bulk_conversion() const
+{
+	return m_bulkConversion;
+}
+
+Error Python::start_workers(int p_count, const String& p_executable, int p_ringSize)
+{
+	Error err = m_workers.start(p_count, p_executable, p_ringSize);
+	SceneTree* tree = SceneTree::get_singleton();
+	if (err == OK && tree && !tree->is_connected("idle_frame", this, "_poll_workers"))
+		tree->connect("idle_frame", this, "_poll_workers");
+	return err;
+}
+
+void Python::stop_workers()
+{
+	SceneTree* tree = SceneTree::get_singleton();
+	if (tree && tree->is_connected("idle_frame", this, "_poll_workers"))
+		tree->disconnect("idle_frame", this, "_poll_workers");
+	m_workers.stop();
+	_poll_workers();
+}
+
+int Python::worker_call(const String& p_module, const String& p_function, const Array& p_args)
+{
+	return m_workers.submit(p_module, p_function, p_args);
+}
+
+// Blocks until the call finishes; a negative timeout waits forever.
+Variant Python::worker_wait(int p_id, int p_timeoutMsec)
+{
+	uint64_t start = OS::get_singleton()->get_ticks_msec();
+	Variant value;
+	String error;
+	while (!m_workers.take_result(p_id, value, error))
+	{
+		if (!m_workers.is_pending(p_id))
+		{
+			ERR_FAIL_COND_V_MSG(!m_workers.was_submitted(p_id), Variant(), "Unknown worker call id " + itos(p_id) + ".");
+			ERR_FAIL_V_MSG(Variant(), "The result of worker call " + itos(p_id) + " was already taken, or delivered through worker_completed/worker_failed too long ago.");
+		}
+		if (p_timeoutMsec >= 0 && OS::get_singleton()->get_ticks_msec() - start >= (uint64_t)p_timeoutMsec)
+			return Variant();
+		OS::get_singleton()->delay_usec(100);
+		m_workers.poll();
+	}
+	if (error != "")
+		ERR_PRINT(error);
+	return value;
+}
+
+void Python::set_worker_timeout(int p_msec)
+{
+	m_workers.set_timeout(MAX(p_msec, 1) * 1000ULL);
+}
+
+int Python::get_worker_timeout() const
+{
+	return m_workers.get_timeout() / 1000;
+}
+
+void Python::_poll_workers()
+{
+	m_workers.poll();
+	int id;
+	Variant value;
+	String error;
+	while (m_workers.take_completed(id, value, error))
+	{
+		if (error != "")
+			emit_signal("worker_failed", id, error);
+		else
+			emit_signal("worker_completed", id, value);
+	}
+}
+
+// Receivers are kept here while connected; the ones whose connection is gone (source
+// freed, oneshot fired, disconnected) are dropped on the next connect.
+Ref<PySignalReceiver> Python::connect_signal(Object* p_object, const String& p_signal, const Variant& p_callable, const Array& p_binds, int p_flags)
+{
+	for (List<Ref<PySignalReceiver> >::Element* E = m_receivers.front(); E;)
+	{
+		List<Ref<PySignalReceiver> >::Element* next = E->next();
+		if (!E->get()->is_connected_to())
+			m_receivers.erase(E);
+		E = next;
+	}
+
+	PyObject* callable = PyScript::gd2py(p_callable);
+	Ref<PySignalReceiver> receiver;
+	receiver.instance();
+	Error err = receiver->connect_to(p_object, p_signal, callable, p_binds, p_flags);
+	if (callable != Py_None)
+		Py_XDECREF(callable);
+	if (err != OK)
+		return Ref<PySignalReceiver>();
+	m_receivers.push_back(receiver);
+	return receiver;
+}
+
+// Disconnects every receiver of p_object's p_signal that calls p_callable.
+bool Python::disconnect_signal(Object* p_object, const String& p_signal, const Variant& p_callable)
+{
+	ERR_FAIL_COND_V(!p_object, false);
+	PyObject* callable = PyScript::gd2py(p_callable);
+	bool ret = false;
+	for (List<Ref<PySignalReceiver> >::Element* E = m_receivers.front(); E;)
+	{
+		List<Ref<PySignalReceiver> >::Element* next = E->next();
+		Ref<PySignalReceiver> receiver = E->get();
+		if (receiver->is_source(p_object, p_signal, callable))
+		{
+			receiver->disconnect_from();
+			m_receivers.erase(E);
+			ret = true;
+		}
+		E = next;
+	}
+	if (callable != Py_None)
+		Py_XDECREF(callable);
+	return ret;
+}
+
+// The loop is created on first use and then stepped from idle_frame.
+PyObject* Python::get_async_loop()
+{
+	if (m_asyncLoop)
+		return m_asyncLoop;
+
+	PyObject* asyncio = PyImport_ImportModule("asyncio");
+	if (!asyncio)
+	{
+		PyErr_Print();
+		return NULL;
+	}
+	PyObject* loop = PyObject_CallMethod(asyncio, "new_event_loop", NULL);
+	PyObject* ret = loop ? PyObject_CallMethod(asyncio, "set_event_loop", "O", loop) : NULL;
+	Py_DECREF(asyncio);
+	if (!ret)
+	{
+		PyErr_Print();
+		Py_XDECREF(loop);
+		return NULL;
+	}
+	Py_DECREF(ret);
+
+	m_asyncLoop = loop;
+	m_asyncStop = PyObject_GetAttrString(loop, "stop");
+	// _ready is the deque of callbacks runnable now; without it every step is a single iteration.
+	m_asyncReady = PyObject_GetAttrString(loop, "_ready");
+	PyErr_Clear();
+
+	SceneTree* tree = SceneTree::get_singleton();
+	if (tree && !tree->is_connected("idle_frame", this, "_async_step"))
+		tree->connect("idle_frame", this, "_async_step");
+	return m_asyncLoop;
+}
+
+Ref<PyFuture> Python::run_coroutine(const Variant& p_coroutine)
+{
+	PyObject* loop = get_async_loop();
+	ERR_FAIL_COND_V_MSG(!loop, Ref<PyFuture>(), "Can't create the asyncio event loop.");
+
+	PyObject* coro = PyScript::gd2py(p_coroutine);
+	PyObject* asyncio = PyImport_ImportModule("asyncio");
+	PyObject* ensureFuture = asyncio ? PyObject_GetAttrString(asyncio, "ensure_future") : NULL;
+	Py_XDECREF(asyncio);
+	PyObject* task = NULL;
+	if (ensureFuture)
+	{
+		PyObject* args = PyTuple_Pack(1, coro);
+		PyObject* kwargs = Py_BuildValue("{s:O}", "loop", loop);
+		task = PyObject_Call(ensureFuture, args, kwargs);
+		Py_DECREF(args);
+		Py_XDECREF(kwargs);
+		Py_DECREF(ensureFuture);
+	}
+	if (coro != Py_None)
+		Py_XDECREF(coro);
+	if (!task)
+	{
+		PyErr_Print();
+		ERR_FAIL_V_MSG(Ref<PyFuture>(), "run_coroutine() needs a Python awaitable.");
+	}
+
+	Ref<PyFuture> future;
+	future.instance();
+	future->set_task(task);
+	PyObject* callback = PyFuture::create_done_callback(future.ptr());
+	PyObject* ret = callback ? PyObject_CallMethod(task, "add_done_callback", "O", callback) : NULL;
+	if (!ret)
+		PyErr_Print();
+	Py_XDECREF(ret);
+	Py_XDECREF(callback);
+	Py_DECREF(task);
+	return future;
+}
+
+Ref<PyFunctionState> Python::drive(const Variant& p_generator, int p_steps, int p_budgetUsec, Object* p_object, const String& p_signal)
+{
+	PyObject* generator = PyScript::gd2py(p_generator);
+	Ref<PyFunctionState> state;
+	state.instance();
+	Error err = state->start(generator, p_object, p_signal, p_steps, p_budgetUsec);
+	if (generator != Py_None)
+		Py_XDECREF(generator);
+	ERR_FAIL_COND_V(err != OK, Ref<PyFunctionState>());
+	return state;
+}
+
+// Runs loop iterations until nothing is ready or p_usec is spent. One iteration is
+// call_soon(stop) + run_forever(), which polls the selector without blocking.
+void Python::step_async(int p_usec)
+{
+	if (!m_asyncLoop || !m_asyncStop || m_asyncStepping)
+		return;
+
+	m_asyncStepping = true;
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
+	while (true)
+	{
+		PyObject* ret = PyObject_CallMethod(m_asyncLoop, "call_soon", "O", m_asyncStop);
+		Py_XDECREF(ret);
+		ret = ret ? PyObject_CallMethod(m_asyncLoop, "run_forever", NULL) : NULL;
+		if (!ret)
+		{
+			PyErr_Print();
+			break;
+		}
+		Py_DECREF(ret);
+
+		if (!m_asyncReady || PyObject_Length(m_asyncReady) <= 0)
+			break;
+		if (OS::get_singleton()->get_ticks_usec() - start >= (uint64_t)p_usec)
+			break;
+	}
+	PyErr_Clear();
+	m_asyncStepping = false;
+}
+
+void Python::_async_step()
+{
+	step_async(m_asyncBudget);
+}
+
+void Python::set_async_budget(int p_usec)
+{
+	m_asyncBudget = MAX(p_usec, 1);
+}
+
+int Python::get_async_budget() const
+{
+	return m_asyncBudget;
+}
+
+Python::~Python()
+{
+	m_receivers.clear();
+	if (m_asyncLoop)
+	{
+		PyObject* ret = PyObject_CallMethod(m_asyncLoop, "close", NULL);
+		if (!ret)
+			PyErr_Clear();
+		Py_XDECREF(ret);
+	}
+	Py_XDECREF(m_asyncReady);
+	Py_XDECREF(m_asyncStop);
+	Py_XDECREF(m_asyncLoop);
+}
+
+// Times p_iterations conversions of p_value each way, node by node and through the bulk codec,
+// and p_iterations FuncRef calls from Python with the scratch arena on and off.
+Dictionary Python::benchmark_conversion(const Variant& p_value, int p_iterations)
+{
+	Dictionary ret;
+	bool bulk = m_bulkConversion;
+	OS* os = OS::get_singleton();
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		m_bulkConversion = pass == 1;
+		String mode = m_bulkConversion ? "bulk" : "recursive";
+
+		uint64_t start = os->get_ticks_usec();
+		for (int i = 0; i < p_iterations; ++i)
+		{
+			PyObject* obj = PyScript::gd2py(p_value);
+			if (obj != Py_None)
+				Py_XDECREF(obj);
+		}
+		ret[mode + "_gd2py_usec"] = os->get_ticks_usec() - start;
+
+		PyObject* obj = PyScript::gd2py(p_value);
+		start = os->get_ticks_usec();
+		for (int i = 0; i < p_iterations; ++i)
+		{
+			PyScript::py2gd(obj);
+		}
+		ret[mode + "_py2gd_usec"] = os->get_ticks_usec() - start;
+		if (obj != Py_None)
+			Py_XDECREF(obj);
+	}
+	m_bulkConversion = bulk;
+
+	// Conversions don't touch the scratch arena; a Python -> Godot FuncRef call does, so
+	// time that with the arena on and off.
+	Ref<FuncRef> funcRef;
+	funcRef.instance();
+	funcRef->set_instance(this);
+	funcRef->set_function("has_method");
+	PyObject* func = PyScript::func_gd2py(funcRef);
+	PyObject* arg = PyUnicode_FromString("get_name");
+	bool enabled = PyScratchArena::is_enabled();
+	PyScratchArena& arena = PyScratchArena::get();
+	arena.reset_high_water();
+	for (int pass = 0; func && arg && pass < 2; ++pass)
+	{
+		PyScratchArena::set_enabled(pass == 0);
+		uint64_t start = os->get_ticks_usec();
+		for (int i = 0; i < p_iterations; ++i)
+		{
+			PyObject* r = PyObject_CallOneArg(func, arg);
+			Py_XDECREF(r);
+		}
+		ret[pass == 0 ? "arena_call_usec" : "heap_call_usec"] = os->get_ticks_usec() - start;
+	}
+	PyScratchArena::set_enabled(enabled);
+	Py_XDECREF(arg);
+	Py_XDECREF(func);
+	PyErr_Clear();
+
+	ret["iterations"] = p_iterations;
+	ret["scratch_arena"] = enabled;
+	ret["arena_high_water_bytes"] = (int64_t)arena.get_high_water();
+	return ret;
+}
+
+// Per-call cost of CPython itself and of a GDScript -> Python call through PyScript.
+// Compare a shared and a python_static build with the same iterations.
+Dictionary Python::benchmark_calls(int p_iterations)
+{
+	Dictionary ret;
+	PyObject* builtins = PyImport_ImportModule("builtins");
+	ERR_FAIL_COND_V(!builtins, ret);
+	PyObject* len = PyObject_GetAttrString(builtins, "len");
+	PyObject* arg = PyTuple_New(0);
+	PyObject* name = PyUnicode_InternFromString("len");
+	OS* os = OS::get_singleton();
+
+	uint64_t start = os->get_ticks_usec();
+	for (int i = 0; i < p_iterations; ++i)
+	{
+		PyObject* r = PyObject_CallOneArg(len, arg);
+		Py_XDECREF(r);
+	}
+	ret["c_api_call_usec"] = os->get_ticks_usec() - start;
+
+	start = os->get_ticks_usec();
+	for (int i = 0; i < p_iterations; ++i)
+	{
+		PyObject* r = PyObject_GetAttr(builtins, name);
+		Py_XDECREF(r);
+	}
+	ret["c_api_getattr_usec"] = os->get_ticks_usec() - start;
+
+	Ref<PyScript> script;
+	script.instance();
+	script->set_module(builtins);
+	Variant value = Array();
+	const Variant* argptr = &value;
+	Variant::CallError err;
+	start = os->get_ticks_usec();
+	for (int i = 0; i < p_iterations; ++i)
+	{
+		script->call("len", &argptr, 1, err);
+	}
+	ret["bridge_call_usec"] = os->get_ticks_usec() - start;
+
+	Py_DECREF(name);
+	Py_DECREF(arg);
+	Py_XDECREF(len);
+	Py_DECREF(builtins);
+	PyErr_Clear();
+	ret["iterations"] = p_iterations;
+#ifdef PYSCRIPT_STATIC
+	ret["static"] = true;
+#else
+	ret["static"] = false;
+#endif
+	return ret;
+}
+
+// Interpreter start-up and the time spent in set_path imports, for comparing cold starts.
+Dictionary Python::get_startup_stats() const
+{
+	Dictionary ret;
+	ret["initialize_usec"] = m_initUsec;
+	ret["import_usec"] = m_importUsec;
+	ret["imports"] = m_importCount;
+	String bundle = OS::get_singleton()->get_executable_path().get_base_dir().plus_file("pyscript_bundle.zip");
+	ret["bundled"] = FileAccess::exists(bundle);
+	return ret;
+}
+
+// From now on records every import as a tree of self/cumulative times; false stops recording.
+// Turning it on again starts a new profile.
+bool Python::profile_imports(bool p_enabled)
+{
+	return imports_set_profiling(p_enabled);
+}
+
+Dictionary Python::get_import_profile() const
+{
+	return imports_get_profile();
+}
+
+// Imports p_names on a background thread. Each idle_frame lends it the GIL for
+// preload_budget microseconds; modules_preloaded is emitted when it is done.
+bool Python::preload_modules(const PoolStringArray& p_names)
+{
+	SceneTree* tree = SceneTree::get_singleton();
+	ERR_FAIL_COND_V_MSG(!tree, false, "Preloading needs a running SceneTree.");
+	if (!imports_preload(p_names))
+		return false;
+	if (!tree->is_connected("idle_frame", this, "_preload_step"))
+		tree->connect("idle_frame", this, "_preload_step");
+	return true;
+}
+
+bool Python::is_preloading() const
+{
+	return imports_is_preloading();
+}
+
+void Python::_preload_step()
+{
+	if (imports_preload_yield(m_preloadBudget))
+		return;
+	SceneTree* tree = SceneTree::get_singleton();
+	if (tree && tree->is_connected("idle_frame", this, "_preload_step"))
+		tree->disconnect("idle_frame", this, "_preload_step");
+	emit_signal("modules_preloaded", imports_get_preload_result());
+}
+
+void Python::set_preload_budget(int p_usec)
+{
+	m_preloadBudget = MAX(p_usec, 1);
+}
+
+int Python::get_preload_budget() const
+{
+	return m_preloadBudget;
+}
+
+void Python::set_memory_tracing(bool p_enabled)
+{
+	memory_set_tracing(p_enabled);
+}
+
+bool Python::is_memory_tracing() const
+{
+	return memory_is_tracing();
+}
+
+Dictionary Python::memory_snapshot(int p_limit)
+{
+	ERR_FAIL_COND_V_MSG(!memory_is_tracing(), Dictionary(), "memory_snapshot() needs memory_tracing on.");
+	return ::memory_snapshot(p_limit);
+}
+
+// A soft limit in bytes on memory_used(); 0 turns it off.
+void Python::set_heap_budget(int64_t p_bytes)
+{
+	p_bytes = MAX(p_bytes, (int64_t)0);
+	SceneTree* tree = SceneTree::get_singleton();
+	ERR_FAIL_COND_MSG(!tree && p_bytes > 0, "The heap budget is checked from idle_frame and needs a running SceneTree.");
+	ERR_FAIL_COND_MSG(p_bytes > 0 && memory_rss() < 0 && !memory_is_tracing(), "The process memory can't be read on this platform; turn memory_tracing on to use the heap budget.");
+	m_heapBudget = p_bytes;
+	m_heapOver = false;
+	if (!tree)
+		return;
+	if (m_heapBudget > 0)
+	{
+		if (!tree->is_connected("idle_frame", this, "_heap_step"))
+			tree->connect("idle_frame", this, "_heap_step");
+	}
+	else if (tree->is_connected("idle_frame", this, "_heap_step"))
+	{
+		tree->disconnect("idle_frame", this, "_heap_step");
+	}
+}
+
+int64_t Python::get_heap_budget() const
+{
+	return m_heapBudget;
+}
+
+// Over budget: one full collection, then heap_budget_exceeded. It is emitted again only
+// after the heap has been back under the budget.
+void Python::_heap_step()
+{
+	int64_t bytes = memory_used();
+	if (bytes < 0 || bytes <= m_heapBudget)
+	{
+		m_heapOver = false;
+		return;
+	}
+	if (m_heapOver)
+		return;
+	m_heapOver = true;
+	bytes = memory_collect();
+	emit_signal("heap_budget_exceeded", bytes, m_heapBudget, memory_blocks());
+}
+
+Ref<PyCode> Python::compile(const String& p_source, const String& p_mode)
+{
+	Ref<PyCode> code;
+	code.instance();
+	if (code->compile(p_source, p_mode) != OK)
+		return Ref<PyCode>();
+	return code;
+}
+
+Variant Python::eval(const Ref<PyCode>& p_code, const Dictionary& p_locals)
+{
+	ERR_FAIL_COND_V(p_code.is_null(), Variant());
+	return p_code->run(p_locals, false);
+}
+
+// Like eval, and writes the final values of p_locals' keys back into it.
+Variant Python::exec(const Ref<PyCode>& p_code, const Dictionary& p_locals)
+{
+	ERR_FAIL_COND_V(p_code.is_null(), Variant());
+	return p_code->run(p_locals, true);
+}
+
+void Python::set_scratch_arena(bool p_enabled)
+{
+	PyScratchArena::set_enabled(p_enabled);
+}
+
+bool Python::is_scratch_arena() const
+{
+	return PyScratchArena::is_enabled();
+}
+
+void Python::set_wrapper_pool_capacity(int p_capacity)
+{
+	PyWrapperPool::get().set_capacity(p_capacity);
+}
+
+int Python::get_wrapper_pool_capacity() const
+{
+	return PyWrapperPool::get().get_capacity();
+}
+
+Dictionary Python::get_wrapper_pool_stats() const
+{
+	return PyWrapperPool::get().get_stats();
+}
+
+void Python::trim_wrapper_pool()
+{
+	PyWrapperPool::get().trim(0);
+}
+
+void Python::set_name_cache_capacity(int p_capacity)
+{
+	PyNameCache::get().set_capacity(p_capacity);
+}
+
+int Python::get_name_cache_capacity() const
+{
+	return PyNameCache::get().get_capacity();
+}
+
+void Python::set_conversion_max_depth(int p_depth)
+{
+	PyConvertMemo::set_max_depth(p_depth);
+}
+
+int Python::get_conversion_max_depth() const
+{
+	return PyConvertMemo::get_max_depth();
+}
+
+void Python::set_conversion_max_items(int p_items)
+{
+	PyConvertMemo::set_max_items(p_items);
+}
+
+int Python::get_conversion_max_items() const
+{
+	return PyConvertMemo::get_max_items();
+}
+
+static const void* container_id(const Variant& p_value)
+{
+	if (p_value.get_type() == Variant::ARRAY)
+		return p_value.operator Array().id();
+	if (p_value.get_type() == Variant::DICTIONARY)
+		return p_value.operator Dictionary().id();
+	return NULL;
+}
+
+// p_path holds the containers being walked, p_done the ones walked already.
+static int break_cycles(const Variant& p_value, Set<const void*>& p_path, Set<const void*>& p_done)
+{
+	const void* id = container_id(p_value);
+	if (!id || p_done.has(id))
+		return 0;
+	p_path.insert(id);
+	int cut = 0;
+	if (p_value.get_type() == Variant::ARRAY)
+	{
+		Array a = p_value;
+		for (int i = 0; i < a.size(); ++i)
+		{
+			const void* item = container_id(a[i]);
+			if (item && p_path.has(item))
+			{
+				a[i] = Variant();
+				++cut;
+			}
+			else if (item)
+			{
+				cut += break_cycles(a[i], p_path, p_done);
+			}
+		}
+	}
+	else
+	{
+		Dictionary d = p_value;
+		for (const Variant* key = d.next(NULL); key; key = d.next(key))
+		{
+			Variant* value = d.getptr(*key);
+			const void* item = container_id(*value);
+			if (item && p_path.has(item))
+			{
+				*value = Variant();
+				++cut;
+			}
+			else if (item)
+			{
+				cut += break_cycles(*value, p_path, p_done);
+			}
+		}
+	}
+	p_path.erase(id);
+	p_done.insert(id);
+	return cut;
+}
+
+// Sets every Array item or Dictionary value that leads back to a container it is inside
+// of to null, so a cyclic structure from py2gd can be freed. Returns how many were cut.
+int Python::break_cycles(const Variant& p_value)
+{
+	Set<const void*> path;
+	Set<const void*> done;
+	return ::break_cycles(p_value, path, done);
+}
+
+Dictionary Python::get_name_cache_stats() const
+{
+	PyNameCache& cache = PyNameCache::get();
+	Dictionary ret;
+	ret["size"] = cache.get_size();
+	ret["capacity"] = cache.get_capacity();
+	ret["hits"] = cache.get_hits();
+	ret["misses"] = cache.get_misses();
 	return ret;
 }
 
@@ -202,7 +1119,93 @@ void Python::_bind_methods()
 	ClassDB::bind_method(D_METHOD("str", "object"), &Python::str);
 	ClassDB::bind_method(D_METHOD("iter", "object"), &Python::iter);
 	ClassDB::bind_method(D_METHOD("next", "iter", "default"), &Python::next, Variant());
+	ClassDB::bind_method(D_METHOD("get_attrs", "object", "names", "as_array"), &Python::get_attrs, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("set_attrs", "object", "values"), &Python::set_attrs);
+	ClassDB::bind_method(D_METHOD("getitem", "object", "key", "attr"), &Python::getitem, DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("setitem", "object", "key", "value", "attr"), &Python::setitem, DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("slice", "object", "start", "stop", "step", "attr"), &Python::slice, DEFVAL(Variant()), DEFVAL(Variant()), DEFVAL(Variant()), DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("len", "object", "attr"), &Python::len, DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("to_columns", "object", "schema", "attr"), &Python::to_columns, DEFVAL(Dictionary()), DEFVAL(""));
 	ClassDB::bind_method(D_METHOD("run_file", "path", "argv"), &Python::run_file);
+	ClassDB::bind_method(D_METHOD("set_typed_list_threshold", "threshold"), &Python::set_typed_list_threshold);
+	ClassDB::bind_method(D_METHOD("get_typed_list_threshold"), &Python::get_typed_list_threshold);
+
+	ClassDB::bind_method(D_METHOD("set_hot_reload", "enabled"), &Python::set_hot_reload);
+	ClassDB::bind_method(D_METHOD("is_hot_reload"), &Python::is_hot_reload);
+	ClassDB::bind_method(D_METHOD("set_hot_reload_budget", "usec"), &Python::set_hot_reload_budget);
+	ClassDB::bind_method(D_METHOD("get_hot_reload_budget"), &Python::get_hot_reload_budget);
+	ClassDB::bind_method(D_METHOD("reload_changed"), &Python::reload_changed);
+	ClassDB::bind_method(D_METHOD("_hot_reload_step"), &Python::_hot_reload_step);
+	ClassDB::bind_method(D_METHOD("set_bulk_conversion", "enabled"), &Python::set_bulk_conversion);
+	ClassDB::bind_method(D_METHOD("is_bulk_conversion"), &Python::is_bulk_conversion);
+	ClassDB::bind_method(D_METHOD("benchmark_conversion", "value", "iterations"), &Python::benchmark_conversion, DEFVAL(100));
+	ClassDB::bind_method(D_METHOD("benchmark_calls", "iterations"), &Python::benchmark_calls, DEFVAL(100000));
+	ClassDB::bind_method(D_METHOD("get_startup_stats"), &Python::get_startup_stats);
+	ClassDB::bind_method(D_METHOD("profile_imports", "enabled"), &Python::profile_imports);
+	ClassDB::bind_method(D_METHOD("get_import_profile"), &Python::get_import_profile);
+	ClassDB::bind_method(D_METHOD("preload_modules", "modules"), &Python::preload_modules);
+	ClassDB::bind_method(D_METHOD("is_preloading"), &Python::is_preloading);
+	ClassDB::bind_method(D_METHOD("set_preload_budget", "usec"), &Python::set_preload_budget);
+	ClassDB::bind_method(D_METHOD("get_preload_budget"), &Python::get_preload_budget);
+	ClassDB::bind_method(D_METHOD("_preload_step"), &Python::_preload_step);
+	ClassDB::bind_method(D_METHOD("set_memory_tracing", "enabled"), &Python::set_memory_tracing);
+	ClassDB::bind_method(D_METHOD("is_memory_tracing"), &Python::is_memory_tracing);
+	ClassDB::bind_method(D_METHOD("memory_snapshot", "limit"), &Python::memory_snapshot, DEFVAL(10));
+	ClassDB::bind_method(D_METHOD("set_heap_budget", "bytes"), &Python::set_heap_budget);
+	ClassDB::bind_method(D_METHOD("get_heap_budget"), &Python::get_heap_budget);
+	ClassDB::bind_method(D_METHOD("_heap_step"), &Python::_heap_step);
+	ClassDB::bind_method(D_METHOD("compile", "source", "mode"), &Python::compile, DEFVAL("eval"));
+	ClassDB::bind_method(D_METHOD("eval", "code", "locals"), &Python::eval, DEFVAL(Dictionary()));
+	ClassDB::bind_method(D_METHOD("exec", "code", "locals"), &Python::exec, DEFVAL(Dictionary()));
+	ClassDB::bind_method(D_METHOD("set_scratch_arena", "enabled"), &Python::set_scratch_arena);
+	ClassDB::bind_method(D_METHOD("is_scratch_arena"), &Python::is_scratch_arena);
+	ClassDB::bind_method(D_METHOD("set_conversion_max_depth", "depth"), &Python::set_conversion_max_depth);
+	ClassDB::bind_method(D_METHOD("get_conversion_max_depth"), &Python::get_conversion_max_depth);
+	ClassDB::bind_method(D_METHOD("set_conversion_max_items", "items"), &Python::set_conversion_max_items);
+	ClassDB::bind_method(D_METHOD("get_conversion_max_items"), &Python::get_conversion_max_items);
+	ClassDB::bind_method(D_METHOD("break_cycles", "value"), &Python::break_cycles);
+	ClassDB::bind_method(D_METHOD("set_name_cache_capacity", "capacity"), &Python::set_name_cache_capacity);
+	ClassDB::bind_method(D_METHOD("get_name_cache_capacity"), &Python::get_name_cache_capacity);
+	ClassDB::bind_method(D_METHOD("get_name_cache_stats"), &Python::get_name_cache_stats);
+	ClassDB::bind_method(D_METHOD("set_wrapper_pool_capacity", "capacity"), &Python::set_wrapper_pool_capacity);
+	ClassDB::bind_method(D_METHOD("get_wrapper_pool_capacity"), &Python::get_wrapper_pool_capacity);
+	ClassDB::bind_method(D_METHOD("get_wrapper_pool_stats"), &Python::get_wrapper_pool_stats);
+	ClassDB::bind_method(D_METHOD("trim_wrapper_pool"), &Python::trim_wrapper_pool);
+	ClassDB::bind_method(D_METHOD("start_workers", "count", "executable", "ring_size"), &Python::start_workers, DEFVAL("python"), DEFVAL(1 << 22));
+	ClassDB::bind_method(D_METHOD("stop_workers"), &Python::stop_workers);
+	ClassDB::bind_method(D_METHOD("worker_call", "module", "function", "args"), &Python::worker_call, DEFVAL(Array()));
+	ClassDB::bind_method(D_METHOD("worker_wait", "id", "timeout_msec"), &Python::worker_wait, DEFVAL(-1));
+	ClassDB::bind_method(D_METHOD("set_worker_timeout", "msec"), &Python::set_worker_timeout);
+	ClassDB::bind_method(D_METHOD("get_worker_timeout"), &Python::get_worker_timeout);
+	ClassDB::bind_method(D_METHOD("_poll_workers"), &Python::_poll_workers);
+	ClassDB::bind_method(D_METHOD("connect_signal", "object", "signal", "callable", "binds", "flags"), &Python::connect_signal, DEFVAL(Array()), DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("disconnect_signal", "object", "signal", "callable"), &Python::disconnect_signal);
+	ClassDB::bind_method(D_METHOD("run_coroutine", "coroutine"), &Python::run_coroutine);
+	ClassDB::bind_method(D_METHOD("step_async", "usec"), &Python::step_async);
+	ClassDB::bind_method(D_METHOD("drive", "generator", "steps", "budget_usec", "object", "signal"), &Python::drive, DEFVAL(1), DEFVAL(0), DEFVAL(Variant()), DEFVAL(""));
+	ClassDB::bind_method(D_METHOD("set_async_budget", "usec"), &Python::set_async_budget);
+	ClassDB::bind_method(D_METHOD("get_async_budget"), &Python::get_async_budget);
+	ClassDB::bind_method(D_METHOD("_async_step"), &Python::_async_step);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "typed_list_threshold"), "set_typed_list_threshold", "get_typed_list_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "hot_reload"), "set_hot_reload", "is_hot_reload");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "hot_reload_budget"), "set_hot_reload_budget", "get_hot_reload_budget");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "bulk_conversion"), "set_bulk_conversion", "is_bulk_conversion");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "scratch_arena"), "set_scratch_arena", "is_scratch_arena");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "conversion_max_depth"), "set_conversion_max_depth", "get_conversion_max_depth");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "conversion_max_items"), "set_conversion_max_items", "get_conversion_max_items");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "name_cache_capacity"), "set_name_cache_capacity", "get_name_cache_capacity");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "wrapper_pool_capacity"), "set_wrapper_pool_capacity", "get_wrapper_pool_capacity");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "worker_timeout"), "set_worker_timeout", "get_worker_timeout");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "async_budget"), "set_async_budget", "get_async_budget");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "preload_budget"), "set_preload_budget", "get_preload_budget");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "memory_tracing"), "set_memory_tracing", "is_memory_tracing");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "heap_budget"), "set_heap_budget", "get_heap_budget");
+
+	ADD_SIGNAL(MethodInfo("worker_completed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::NIL, "result")));
+	ADD_SIGNAL(MethodInfo("worker_failed", PropertyInfo(Variant::INT, "id"), PropertyInfo(Variant::STRING, "error")));
+	ADD_SIGNAL(MethodInfo("modules_preloaded", PropertyInfo(Variant::DICTIONARY, "result")));
+	ADD_SIGNAL(MethodInfo("heap_budget_exceeded", PropertyInfo(Variant::INT, "bytes"), PropertyInfo(Variant::INT, "budget"), PropertyInfo(Variant::INT, "blocks")));
 }
 
 static PyObject* gd_function(PyObject* p_self, PyObject* p_args)
@@ -217,20 +1220,20 @@ static PyObject* gd_function(PyObject* p_self, PyObject* p_args)
 			if (ptr)
 			{
 				
+				PyScratchArena::Scope scope;
+				PyScratchArena& arena = PyScratchArena::get();
 				Variant::CallError err;
 				int argc = PyObject_Size(p_args);
 				const Variant** argptrs = NULL;
-				Vector<Variant> arglist;
-				arglist.resize(argc);
-				auto wptr = arglist.ptrw();
 				if (argc > 0)
 				{
-					argptrs = (const Variant**)alloca(sizeof(Variant*) * argc);
+					Variant* args = arena.variants(argc);
+					argptrs = arena.pointers(argc);
 					for (int i = 0; i < argc; ++i)
 					{
 						auto temp = PySequence_Fast_GET_ITEM(p_args, i);
-						wptr[i] = PyScript::py2gd(temp);
-						argptrs[i] = &(wptr[i]);
+						args[i] = PyScript::py2gd(temp);
+						argptrs[i] = &args[i];
 					}
 				}
 				ptr->call_func(argptrs, argc, err);
@@ -254,6 +1257,15 @@ inline PyObject* PyScript::gd2py(const Variant& p_source)
 	return gd2py(&p_source);
 }
 
+// gd2py hands out Py_None borrowed; this is for the slots that steal a reference.
+PyObject* PyScript::gd2py_owned(const Variant& p_source, bool p_tuplePriority)
+{
+	PyObject* ret = gd2py(&p_source, p_tuplePriority);
+	if (ret == Py_None)
+		Py_INCREF(ret);
+	return ret;
+}
+
 PyObject* PyScript::gd2py(const Variant* p_source, bool p_priority)
 {
 	switch (p_source->get_type())
@@ -267,7 +1279,11 @@ PyObject* PyScript::gd2py(const Variant* p_source, bool p_priority)
 	case Variant::REAL:
 		return PyFloat_FromDouble(p_source->operator double());
 	case Variant::STRING:
-		return PyUnicode_FromString(p_source->operator String().utf8().get_data());
+	{
+		// Straight from the CharType data, no UTF-8 CharString in between.
+		String str = p_source->operator String();
+		return PyUnicode_FromWideChar(str.ptr(), str.length());
+	}
 	case Variant::VECTOR2:
 	case Variant::RECT2:
 	case Variant::VECTOR3:
@@ -313,35 +1329,88 @@ PyObject* PyScript::gd2py(const Variant* p_source, bool p_priority)
 			Py_INCREF(inst->get_py_obj());
 			return inst->get_py_obj();
 		}
+		Object* obj = *p_source;
+		if (obj && ObjectDB::instance_validate(obj))
+		{
+			PyObject* proxy = object_proxy_new(obj);
+			if (proxy)
+				return proxy;
+			PyErr_Print();
+		}
 	} break;
 	case Variant::DICTIONARY:
 	{
-		PyObject* pyDict = PyDict_New();
 		Dictionary dict = p_source->operator Dictionary();
-		Array keys = dict.keys();
-		Array values = dict.values();
-		for (int i = 0; i < dict.size(); ++i)
+		PyConvertMemo::Scope memo("gd2py", dict.size());
+		if (!memo.ok())
+			return Py_None;
+		PyObject* shared = memo->find(dict.id(), p_priority);
+		if (shared)
+			return shared;
+		// Only from the outermost container: a source the codec turns down also has to
+		// be memoized below, or its shared parts would convert once per reference.
+		if (memo.is_outermost() && Python::get_singleton() && Python::get_singleton()->is_bulk_conversion())
+		{
+			PyObject* ret = codec_gd2py(*p_source, p_priority);
+			if (ret)
+			{
+				memo->add(dict.id(), p_priority, ret);
+				return ret;
+			}
+		}
+		PyObject* pyDict = PyDict_New();
+		memo->add(dict.id(), p_priority, pyDict);
+		// Walk the entries in place instead of copying keys() and values().
+		for (const Variant* key = dict.next(NULL); key; key = dict.next(key))
 		{
-			PyObject* pyValue = gd2py(&(values[i]));
-			if (PyDict_SetItem(pyDict, gd2py(&(keys[i]), true), pyValue) != 0)
+			PyObject* pyValue = gd2py(dict.getptr(*key));
+			// String keys come from the name cache as interned strs.
+			PyObject* pyKey = key->get_type() == Variant::STRING ? PyNameCache::get().to_py(*key) : gd2py(key, true);
+			if (!pyKey || PyDict_SetItem(pyDict, pyKey, pyValue) != 0)
 			{
+				PyErr_Clear();
 				print_error("PyDict_SetItem failed!");
 			}
-			Py_XDECREF(pyValue);
+			if (pyKey != Py_None)
+				Py_XDECREF(pyKey);
+			if (pyValue != Py_None)
+				Py_XDECREF(pyValue);
 		}
 
+		if (memo.is_outermost() && memo.has_failed())
+		{
+			Py_DECREF(pyDict);
+			return Py_None;
+		}
 		return pyDict;
 	}
 	case Variant::ARRAY:
 	{
 		Array a = p_source->operator Array();
+		PyConvertMemo::Scope memo("gd2py", a.size());
+		if (!memo.ok())
+			return Py_None;
+		PyObject* shared = memo->find(a.id(), p_priority);
+		if (shared)
+			return shared;
+		// Bulk only from the outermost container, as for dictionaries.
+		if (memo.is_outermost() && Python::get_singleton() && Python::get_singleton()->is_bulk_conversion())
+		{
+			PyObject* ret = codec_gd2py(*p_source, p_priority);
+			if (ret)
+			{
+				memo->add(a.id(), p_priority, ret);
+				return ret;
+			}
+		}
 		PyObject* pyList;
 		if (p_priority)
 		{
 			pyList = PyTuple_New(a.size());
+			memo->add(a.id(), true, pyList);
 			for (int i = 0; i < a.size(); ++i)
 			{
-				if (PyTuple_SetItem(pyList, i, gd2py(a[i])) != 0)
+				if (PyTuple_SetItem(pyList, i, gd2py_owned(a[i])) != 0)
 				{
 					print_error("PyTuple_SetItem index error!");
 				}
@@ -350,15 +1419,21 @@ PyObject* PyScript::gd2py(const Variant* p_source, bool p_priority)
 		else
 		{
 			pyList = PyList_New(a.size());
+			memo->add(a.id(), false, pyList);
 			for (int i = 0; i < a.size(); ++i)
 			{
-				if (PyList_SetItem(pyList, i, gd2py(a[i])) != 0)
+				if (PyList_SetItem(pyList, i, gd2py_owned(a[i])) != 0)
 				{
 					print_error("PyList_SetItem index error!");
 				}
 			}
 		}
-		
+
+		if (memo.is_outermost() && memo.has_failed())
+		{
+			Py_DECREF(pyList);
+			return Py_None;
+		}
 		return pyList;
 	}
 	case Variant::POOL_BYTE_ARRAY:
@@ -416,6 +1491,252 @@ PyObject* PyScript::gd2py(const Variant* p_source, bool p_priority)
 	return Py_None;
 }
 
+template <class S, class D>
+static inline void buffer_copy(const S* p_src, D* p_dst, int p_count)
+{
+	for (int i = 0; i < p_count; ++i)
+	{
+		p_dst[i] = (D)p_src[i];
+	}
+}
+
+template <class T>
+static inline void buffer_copy(const T* p_src, T* p_dst, int p_count)
+{
+	memcpy(p_dst, p_src, sizeof(T) * p_count);
+}
+
+template <class D>
+static bool buffer_copy_int(const void* p_src, char p_code, int p_count, D* p_dst)
+{
+	switch (p_code)
+	{
+	case 'h':
+		buffer_copy((const short*)p_src, p_dst, p_count);
+		return true;
+	case 'i':
+		buffer_copy((const int*)p_src, p_dst, p_count);
+		return true;
+	case 'l':
+		buffer_copy((const long*)p_src, p_dst, p_count);
+		return true;
+	case 'q':
+		buffer_copy((const long long*)p_src, p_dst, p_count);
+		return true;
+	}
+	return false;
+}
+
+template <class D>
+static bool buffer_copy_real(const void* p_src, char p_code, int p_count, D* p_dst)
+{
+	switch (p_code)
+	{
+	case 'f':
+		buffer_copy((const float*)p_src, p_dst, p_count);
+		return true;
+	case 'd':
+		buffer_copy((const double*)p_src, p_dst, p_count);
+		return true;
+	}
+	return false;
+}
+
+// PoolIntArray holds 32-bit ints. A 64-bit buffer with a value outside that range becomes an
+// Array instead, whose ints are 64-bit; returns false when the Pool array will do.
+template <class T>
+static bool buffer_wide_int(const T* p_src, int p_count, Variant& r_ret)
+{
+	int i = 0;
+	while (i < p_count && p_src[i] >= INT32_MIN && p_src[i] <= INT32_MAX)
+	{
+		++i;
+	}
+	if (i == p_count)
+		return false;
+
+	Array a;
+	a.resize(p_count);
+	for (i = 0; i < p_count; ++i)
+	{
+		a[i] = (int64_t)p_src[i];
+	}
+	r_ret = a;
+	return true;
+}
+
+// Converts a C-contiguous buffer (bytes, memoryview, array.array, numpy...) to a Pool array.
+// Float buffers whose items are 2/3/4-float records, or 2-d float buffers with 2/3/4 columns,
+// become PoolVector2Array/PoolVector3Array/PoolColorArray.
+bool PyScript::buffer2gd(PyObject* p_source, Variant& r_ret)
+{
+	Py_buffer view;
+	if (PyObject_GetBuffer(p_source, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+	{
+		PyErr_Clear();
+		return false;
+	}
+
+	const char* format = view.format ? view.format : "B";
+	if (*format == '@' || *format == '=' || *format == '<')
+		++format;
+	int fields = 1;
+	if (*format >= '2' && *format <= '4')
+	{
+		fields = *format - '0';
+		++format;
+	}
+	char code = format[1] == '\0' ? format[0] : '\0';
+	Py_ssize_t size = view.itemsize / fields;
+	Py_ssize_t items = size > 0 ? view.len / size : 0;
+	// Pool arrays are indexed by int; larger buffers are left to the caller's fallback.
+	if (view.len > INT32_MAX || items > INT32_MAX)
+	{
+		PyBuffer_Release(&view);
+		return false;
+	}
+	int count = (int)items;
+	if ((code == 'f' || code == 'd') && fields == 1 && view.ndim == 2 && view.shape[1] >= 2 && view.shape[1] <= 4)
+	{
+		fields = view.shape[1];
+	}
+
+	bool ret = true;
+	switch (code)
+	{
+	case 'B':
+	case 'b':
+	case 'c':
+	{
+		PoolByteArray a;
+		a.resize(view.len);
+		memcpy(a.write().ptr(), view.buf, view.len);
+		r_ret = a;
+	} break;
+	case 'h':
+	case 'i':
+	case 'l':
+	case 'q':
+	{
+		if ((code == 'l' && buffer_wide_int((const long*)view.buf, count, r_ret)) ||
+			(code == 'q' && buffer_wide_int((const long long*)view.buf, count, r_ret)))
+		{
+			break;
+		}
+		PoolIntArray a;
+		a.resize(count);
+		ret = buffer_copy_int(view.buf, code, count, a.write().ptr());
+		r_ret = a;
+	} break;
+	case 'f':
+	case 'd':
+	{
+		if (fields == 2)
+		{
+			PoolVector2Array a;
+			a.resize(count / 2);
+			ret = buffer_copy_real(view.buf, code, a.size() * 2, (real_t*)a.write().ptr());
+			r_ret = a;
+		}
+		else if (fields == 3)
+		{
+			PoolVector3Array a;
+			a.resize(count / 3);
+			ret = buffer_copy_real(view.buf, code, a.size() * 3, (real_t*)a.write().ptr());
+			r_ret = a;
+		}
+		else if (fields == 4)
+		{
+			PoolColorArray a;
+			a.resize(count / 4);
+			ret = buffer_copy_real(view.buf, code, a.size() * 4, (float*)a.write().ptr());
+			r_ret = a;
+		}
+		else
+		{
+			PoolRealArray a;
+			a.resize(count);
+			ret = buffer_copy_real(view.buf, code, count, a.write().ptr());
+			r_ret = a;
+		}
+	} break;
+	default:
+		ret = false;
+	}
+
+	PyBuffer_Release(&view);
+	return ret;
+}
+
+// Converts a list or tuple whose items are all exact float, int or str to the matching Pool array.
+// Only tried when Python.typed_list_threshold is not negative and the sequence is at least that long.
+bool PyScript::seq2pool(PyObject* p_source, Variant& r_ret)
+{
+	int threshold = Python::get_singleton() ? Python::get_singleton()->get_typed_list_threshold() : -1;
+	Py_ssize_t size = PySequence_Fast_GET_SIZE(p_source);
+	if (threshold < 0 || size == 0 || size < threshold)
+		return false;
+
+	PyObject** items = PySequence_Fast_ITEMS(p_source);
+	PyTypeObject* tp = Py_TYPE(items[0]);
+	if (tp != &PyFloat_Type && tp != &PyLong_Type && tp != &PyUnicode_Type)
+		return false;
+	for (Py_ssize_t i = 1; i < size; ++i)
+	{
+		if (Py_TYPE(items[i]) != tp)
+			return false;
+	}
+
+	if (tp == &PyFloat_Type)
+	{
+		PoolRealArray a;
+		a.resize(size);
+		PoolRealArray::Write w = a.write();
+		for (Py_ssize_t i = 0; i < size; ++i)
+		{
+			w[i] = PyFloat_AS_DOUBLE(items[i]);
+		}
+		w.release();
+		r_ret = a;
+	}
+	else if (tp == &PyLong_Type)
+	{
+		PoolIntArray a;
+		a.resize(size);
+		PoolIntArray::Write w = a.write();
+		for (Py_ssize_t i = 0; i < size; ++i)
+		{
+			int overflow = 0;
+			long long v = PyLong_AsLongLongAndOverflow(items[i], &overflow);
+			if (overflow || v < INT32_MIN || v > INT32_MAX)
+				return false;
+			w[i] = v;
+		}
+		w.release();
+		r_ret = a;
+	}
+	else
+	{
+		PoolStringArray a;
+		a.resize(size);
+		PoolStringArray::Write w = a.write();
+		for (Py_ssize_t i = 0; i < size; ++i)
+		{
+			Py_ssize_t strSize;
+			auto str = PyUnicode_AsUTF8AndSize(items[i], &strSize);
+			if (!str)
+			{
+				PyErr_Clear();
+				return false;
+			}
+			w[i].parse_utf8(str, strSize);
+		}
+		w.release();
+		r_ret = a;
+	}
+	return true;
+}
+
 Variant PyScript::py2gd(PyObject* p_source)
 {
 	if (p_source == NULL || p_source == Py_None)
@@ -425,6 +1746,8 @@ Variant PyScript::py2gd(PyObject* p_source)
 	if (p_source == Py_True)
 		return true;
 
+	if (object_proxy_check(p_source))
+		return object_proxy_to_variant(p_source);
 	if (PyType_Check(p_source))
 	{
 		//PyTypeObject* pyTp = Py_TYPE(p_source);
@@ -440,15 +1763,11 @@ Variant PyScript::py2gd(PyObject* p_source)
 	{
 		return PyFloat_AsDouble(p_source);
 	}
-	else if (PyByteArray_Check(p_source))
+	else if (PyObject_CheckBuffer(p_source))
 	{
-		PoolByteArray pba;
-		pba.resize(PyByteArray_Size(p_source));
-		auto ptr = pba.write().ptr();
-		char* bytes = PyByteArray_AsString(p_source);
-		memcpy(ptr, bytes, sizeof(uint8_t) * pba.size());
-		delete[] bytes;
-		return pba;
+		Variant ret;
+		if (buffer2gd(p_source, ret))
+			return ret;
 	}
 	else if (PyUnicode_Check(p_source))
 	{
@@ -458,41 +1777,59 @@ Variant PyScript::py2gd(PyObject* p_source)
 		ret.parse_utf8(str, strSize);
 		return ret;
 	}
-	else if (PyTuple_Check(p_source))
+	else if (PyTuple_Check(p_source) || PyList_Check(p_source))
 	{
-		Array a;
-		a.resize(PyTuple_GET_SIZE(p_source));
-		for (int i = 0; i < a.size(); ++i)
+		Py_ssize_t size = PySequence_Fast_GET_SIZE(p_source);
+		PyConvertMemo::Scope memo("py2gd", size);
+		Variant ret;
+		if (!memo.ok() || memo->find(p_source, ret))
+			return ret;
+		// Bulk only from the outermost container, as in gd2py.
+		if ((memo.is_outermost() && Python::get_singleton() && Python::get_singleton()->is_bulk_conversion() && codec_py2gd(p_source, ret)) || seq2pool(p_source, ret))
 		{
-			a[i] = py2gd(PyTuple_GET_ITEM(p_source, i));
+			memo->add(p_source, ret);
+			return ret;
 		}
-		return a;
-	}
-	else if (PyList_Check(p_source))
-	{
 		Array a;
-		a.resize(PyList_GET_SIZE(p_source));
-		for (int i = 0; i < a.size(); ++i)
+		a.resize(size);
+		// In the memo before its items, so a list that contains itself finds this Array.
+		memo->add(p_source, a);
+		PyObject** items = PySequence_Fast_ITEMS(p_source);
+		for (int i = 0; i < size; ++i)
 		{
-			a[i] = py2gd(PyList_GET_ITEM(p_source, i));
+			a[i] = py2gd(items[i]);
 		}
+		if (memo.is_outermost() && memo.has_failed())
+			return Variant();
 		return a;
 	}
 	else if (PyDict_Check(p_source))
 	{
+		PyConvertMemo::Scope memo("py2gd", PyDict_GET_SIZE(p_source));
+		Variant bulk;
+		if (!memo.ok() || memo->find(p_source, bulk))
+			return bulk;
+		if (memo.is_outermost() && Python::get_singleton() && Python::get_singleton()->is_bulk_conversion() && codec_py2gd(p_source, bulk))
+		{
+			memo->add(p_source, bulk);
+			return bulk;
+		}
 		Dictionary d;
+		memo->add(p_source, d);
 		Variant k;
 		PyObject* key, * value;
 		Py_ssize_t pos = 0;
 		
 		while (PyDict_Next(p_source, &pos, &key, &value))
 		{
-			k = py2gd(key);
+			k = PyUnicode_CheckExact(key) ? Variant(String(PyNameCache::get().to_name(key))) : py2gd(key);
 			if (k.get_type() != Variant::NIL)
 			{
 				d[k] = py2gd(value);
 			}
 		}
+		if (memo.is_outermost() && memo.has_failed())
+			return Variant();
 		return d;
 	}
 	else if (PySet_Check(p_source))
@@ -518,17 +1855,7 @@ Variant PyScript::py2gd(PyObject* p_source)
 		script->set_module(p_source);
 		return script;
 	}
-	PyScriptInstance* pyInst = memnew(PyScriptInstance);
-	Reference* owner = memnew(Reference);
-	pyInst->m_owner = owner;
-	Ref<PyScript> script = memnew(PyScript);
-	PyObject* tp = PyObject_Type(p_source);
-	script->set_module(tp);
-	pyInst->m_script = script;
-	pyInst->m_owner->set_script_instance(pyInst);
-	Py_INCREF(p_source);
-	pyInst->m_obj = p_source;
-	return REF(owner);
+	return PyWrapperPool::get().wrap(p_source);
 }
 
 int PyScript::get_py_func_argc(PyObject* p_func)
@@ -639,7 +1966,7 @@ Variant PyScript::call_py_func(PyObject* p_func, const Variant** p_args, int p_a
 	PyObject* args = PyTuple_New(p_argcount);
 	for (int i = 0; i < p_argcount; ++i)
 	{
-		PyTuple_SetItem(args, i, gd2py(p_args[i]));
+		PyTuple_SetItem(args, i, gd2py_owned(*p_args[i]));
 	}
 
 	PyObject* pRet = PyObject_Call(p_func, args, p_kwargs);
@@ -672,11 +1999,13 @@ bool PyScript::_get(const StringName& p_name, Variant& r_ret) const
 		return false;
 	
 	PyObject* mod = get_module();
-	auto prop = String(p_name);
-	PyObject* attr = NULL;
-	if (PyObject_HasAttrString(mod, prop.utf8().get_data()))
+	PyObject* attr = PyNameCache::get().get_attr(mod, p_name);
+	if (!attr)
+	{
+		PyErr_Clear();
+	}
+	else
 	{
-		attr = PyObject_GetAttrString(mod, prop.utf8().get_data());
 		if (PyFunction_Check(attr) || PyInstanceMethod_Check(attr) || PyMethod_Check(attr))
 		{
 			Py_XDECREF(attr);
@@ -698,10 +2027,9 @@ bool PyScript::_set(const StringName& p_name, const Variant& p_value)
 		return false;
 
 	PyObject* mod = get_module();
-	auto prop = String(p_name);
-	auto propUtf8 = prop.utf8();
 	PyObject* v = PyScript::gd2py(p_value);
-	PyObject_SetAttrString(mod, propUtf8.get_data(), v);
+	if (PyNameCache::get().set_attr(mod, p_name, v) != 0)
+		PyErr_Clear();
 	Py_XDECREF(v);
 	return true;
 	/*if (PyObject_HasAttrString(mod, propUtf8.get_data()))
@@ -733,7 +2061,9 @@ Variant PyScript::call(const StringName& p_method, const Variant** p_args, int p
 		return Script::call(p_method, p_args, p_argcount, r_error);
 
 	PyObject* kwarg = NULL;
-	auto method = p_method.operator String();
+	// Looked up as given; only call_with_kwarg names the method in a Variant.
+	const StringName* method = &p_method;
+	StringName kwargMethod;
 	if (p_method == "call_with_kwarg")
 	{
 		if (p_argcount < 2)
@@ -759,30 +2089,31 @@ Variant PyScript::call(const StringName& p_method, const Variant** p_args, int p
 			return Variant();
 		}
 
-		kwarg = gd2py(p_args[p_argcount - 1]);
-		method = p_args[0]->operator String();
+		kwarg = gd2py_owned(*p_args[p_argcount - 1]);
+		kwargMethod = *p_args[0];
+		method = &kwargMethod;
 		p_argcount -= 2;
 		++p_args;
 	}
 
+	PyScratchArena::Scope scope;
 	PyObject* mod = get_module();
 	Variant ret;
-	if (PyObject_HasAttrString(mod, method.utf8().get_data()))
+	PyObject* func = PyNameCache::get().get_attr(mod, *method);
+	if (!func)
+		PyErr_Clear();
+	if (func)
 	{
-		PyObject* func = PyObject_GetAttrString(mod, method.utf8().get_data());
-		if (func)
+		ret = call_py_func(func, p_args, p_argcount, r_error, kwarg);
+		Py_DECREF(func);
+		if (r_error.error == Variant::CallError::CALL_OK)
 		{
-			ret = call_py_func(func, p_args, p_argcount, r_error, kwarg);
-			Py_DECREF(func);
-			if (r_error.error == Variant::CallError::CALL_OK)
-			{
-				Py_XDECREF(kwarg);
-				return ret;
-			}
+			Py_XDECREF(kwarg);
+			return ret;
 		}
 	}
 
-	if ((method == "new" && PyType_Check(mod)) || (method == "call_self" && PyCallable_Check(mod)))
+	if ((*method == "new" && PyType_Check(mod)) || (*method == "call_self" && PyCallable_Check(mod)))
 	{
 		ret = call_py_func(mod, p_args, p_argcount, r_error, kwarg);
 		if (r_error.error == Variant::CallError::CALL_OK)
@@ -858,7 +2189,8 @@ void PyScript::set_module(PyObject* p_module)
 {
 	if (m_obj)
 	{
-		if (PyModule_Check(m_obj))
+		// Types and modules are the ones referenced below.
+		if (PyType_Check(m_obj) || PyModule_Check(m_obj))
 			Py_DECREF(m_obj);
 		m_obj = NULL;
 	}
@@ -888,57 +2220,62 @@ void PyScript::set_module(PyObject* p_module)
 	set_name(m_moduleName);
 }
 
-Vector<PyScript::MethodData> PyScript::get_methods_data() const
+const PyScript::Introspection& PyScript::get_introspection(PyObject* p_obj, Introspection& r_cache)
 {
-	Vector<MethodData> ret;
-	if (!is_valid())
-		return ret;
-	PyObject* mod = get_module();
-	PyObject* dict = PyObject_GenericGetDict(mod, NULL);
-	if (!dict)
-		return ret;
+	PyObject* dict = p_obj ? PyObject_GenericGetDict(p_obj, NULL) : NULL;
+	if (!dict || !PyDict_Check(dict))
+	{
+		PyErr_Clear();
+		Py_XDECREF(dict);
+		r_cache = Introspection();
+		return r_cache;
+	}
 
+	uint64_t version = ((PyDictObject*)dict)->ma_version_tag;
+	if (r_cache.valid && r_cache.version == version)
+	{
+		Py_DECREF(dict);
+		return r_cache;
+	}
+
+	r_cache = Introspection();
+	r_cache.valid = true;
+	r_cache.version = version;
 	PyObject* key, * value;
 	Py_ssize_t pos = 0;
 
 	while (PyDict_Next(dict, &pos, &key, &value))
 	{
-		if (PyFunction_Check(value) || PyMethod_Check(value) || PyInstanceMethod_Check(value) || PyType_Check(value))
+		bool isFunc = PyFunction_Check(value) || PyMethod_Check(value) || PyInstanceMethod_Check(value);
+		if (isFunc || PyType_Check(value))
 		{
 			MethodData md;
 			md.name = py2gd(key);
 			md.argc = get_py_func_argc(value);
-			ret.push_back(md);
+			r_cache.methods.push_back(md);
+			r_cache.methodArgc[md.name] = md.argc;
+		}
+		if (!isFunc)
+		{
+			r_cache.properties.push_back(py2gd(key));
 		}
 	}
-	Py_XDECREF(dict);
-	return ret;
+	Py_DECREF(dict);
+	return r_cache;
 }
 
-Vector<String> PyScript::get_properties() const
+Vector<PyScript::MethodData> PyScript::get_methods_data() const
 {
-	Vector<String> ret;
 	if (!is_valid())
-		return ret;
-	PyObject* mod = get_module();
-	PyObject* dict = PyObject_GenericGetDict(mod, NULL);
-	if (!dict)
-		return ret;
-
-	PyObject* key, * value;
-	Py_ssize_t pos = 0;
-
-	while (PyDict_Next(dict, &pos, &key, &value))
-	{
-		if (PyFunction_Check(value) || PyMethod_Check(value) || PyInstanceMethod_Check(value))
-		{
-			continue;
-		}
+		return Vector<MethodData>();
+	return get_introspection(get_module(), m_introspection).methods;
+}
 
-		ret.push_back(py2gd(key));
-	}
-	Py_XDECREF(dict);
-	return ret;
+Vector<String> PyScript::get_properties() const
+{
+	if (!is_valid())
+		return Vector<String>();
+	return get_introspection(get_module(), m_introspection).properties;
 }
 
 void PyScript::free()
@@ -1047,8 +2384,13 @@ void PyScript::set_path(const String& p_path, bool p_take_over)
 	//{
 	//	modName = modName.substr(0, modName.length() - 4);
 	//}
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
 	PyObject* mod = PyImport_ImportModule(p_path.utf8().get_data());
+	if (Python::get_singleton())
+		Python::get_singleton()->record_import(OS::get_singleton()->get_ticks_usec() - start);
 	set_module(mod);
+	if (mod && Python::get_singleton())
+		Python::get_singleton()->get_reloader().track(mod);
 	Py_XDECREF(mod);
 }
 
@@ -1086,12 +2428,9 @@ Error PyScript::reload(bool p_keep_state)
 
 	if (PyModule_Check(mod))
 	{
-		m_obj = PyImport_ReloadModule(mod);
-		Py_XDECREF(mod);
-		if (!m_obj)
+		// Goes through the reloader so every PyScript holding this module or its classes is updated.
+		if (!Python::get_singleton() || !Python::get_singleton()->get_reloader().reload_module(m_moduleName))
 		{
-			m_moduleName = "";
-			set_name("");
 			//print_error("Reload failed!");
 			return FAILED;
 		}
@@ -1115,32 +2454,31 @@ bool PyScript::has_method(const StringName& p_method) const
 {
 	if (!is_valid())
 		return false;
-	PyObject* mod = get_module();
-	PyObject* dict = PyObject_GenericGetDict(mod, NULL);
-	auto utf8 = p_method.operator String().utf8();
-	PyObject* methName = PyUnicode_FromStringAndSize(utf8.get_data(), utf8.length());
-	bool ret = false;
-	if (dict && PyDict_Contains(dict, methName))
-	{
-		PyObject* meth = PyObject_GenericGetAttr(mod, methName);
-		ret = meth && (PyFunction_Check(meth) || PyInstanceMethod_Check(meth) || PyMethod_Check(meth) || PyType_Check(meth));
-		Py_XDECREF(meth);
-	}
-	Py_XDECREF(dict);
-	Py_DECREF(methName);
-	return ret;
+	return get_introspection(get_module(), m_introspection).methodArgc.has(p_method);
 }
 
 MethodInfo PyScript::get_method_info(const StringName& p_method) const
 {
 	if (!is_valid())
 		return MethodInfo();
+	const int* cachedArgc = get_introspection(get_module(), m_introspection).methodArgc.getptr(p_method);
+	if (cachedArgc)
+	{
+		MethodInfo mi(p_method);
+		for (int i = 0; i < *cachedArgc; ++i)
+		{
+			mi.arguments.push_back(PropertyInfo());
+		}
+		return mi;
+	}
+
+	// Not in the object's own dict, e.g. a method inherited by a class.
 	PyObject* mod = get_module();
-	String method = String(p_method);
-	auto utf8 = method.utf8();
-	PyObject* funcName = PyUnicode_FromStringAndSize(utf8.get_data(), utf8.length());
-	PyObject* func = PyObject_GenericGetAttr(mod, funcName);
-	Py_DECREF(funcName);
+	PyObject* funcName = PyNameCache::get().to_py(p_method);
+	PyObject* func = funcName ? PyObject_GenericGetAttr(mod, funcName) : NULL;
+	Py_XDECREF(funcName);
+	if (!func)
+		PyErr_Clear();
 	if (!func || (!PyFunction_Check(func) && !PyMethod_Check(func) && !PyInstanceMethod_Check(func) && !PyType_Check(func)))
 	{
 		Py_XDECREF(func);
@@ -1249,15 +2587,17 @@ void PyScript::get_members(Set<StringName>* p_members)
 	}
 }
 
-PyScript::PyScript()
+PyScript::PyScript() :
+		m_scriptList(this)
 {	
+	script_list.add(&m_scriptList);
 }
 
 PyScript::~PyScript()
 {
 	if (m_obj)
 	{
-		if (PyModule_Check(m_obj))
+		if (PyType_Check(m_obj) || PyModule_Check(m_obj))
 			Py_DECREF(m_obj);
 		m_obj = NULL;
 	}
@@ -1270,10 +2610,9 @@ bool PyScriptInstance::set(const StringName& p_name, const Variant& p_value)
 		return false;
 
 	PyObject* obj = get_py_obj();
-	auto prop = String(p_name);
-	auto propUtf8 = prop.utf8();
 	PyObject* v = PyScript::gd2py(p_value);
-	PyObject_SetAttrString(obj, propUtf8.get_data(), v);
+	if (PyNameCache::get().set_attr(obj, p_name, v) != 0)
+		PyErr_Clear();
 	Py_XDECREF(v);
 	return true;
 	/*if (PyObject_HasAttrString(obj, propUtf8.get_data()))
@@ -1296,18 +2635,18 @@ bool PyScriptInstance::set(const StringName& p_name, const Variant& p_value)
 
 bool PyScriptInstance::get(const StringName& p_name, Variant& r_ret) const
 {
-	auto na = String(p_name);
-	auto utf8 = na.utf8();
 	PyObject* mod = m_script->get_module();
 	PyObject* obj = get_py_obj();
 	if (!obj || !mod)
 		return false;
 
-	auto prop = String(p_name);
-	PyObject* attr = NULL;
-	if (PyObject_HasAttrString(obj, prop.utf8().get_data()))
+	PyObject* attr = PyNameCache::get().get_attr(obj, p_name);
+	if (!attr)
+	{
+		PyErr_Clear();
+	}
+	else
 	{
-		attr = PyObject_GetAttrString(obj, prop.utf8().get_data());
 		if (PyFunction_Check(attr) || PyInstanceMethod_Check(attr) || PyMethod_Check(attr))
 		{
 			Py_XDECREF(attr);
@@ -1344,24 +2683,11 @@ void PyScriptInstance::get_property_list(List<PropertyInfo>* p_properties) const
 	if (!is_valid())
 		return;
 
-	PyObject* obj = get_py_obj();
-	PyObject* attrs = PyObject_GenericGetDict(obj, NULL);
-	if (!attrs)
-	{
-		return;
-	}
-	PyObject* key, * value;
-	Py_ssize_t pos = 0;
-
-	while (PyDict_Next(attrs, &pos, &key, &value))
+	auto& props = PyScript::get_introspection(get_py_obj(), m_introspection).properties;
+	for (int i = 0; i < props.size(); ++i)
 	{
-		if (PyFunction_Check(value) || PyMethod_Check(value) || PyInstanceMethod_Check(value))
-		{
-			continue;
-		}
-
 		PropertyInfo pi;
-		pi.name = PyScript::py2gd(key);
+		pi.name = props[i];
 		p_properties->push_back(pi);
 	}
 }
@@ -1380,29 +2706,16 @@ void PyScriptInstance::get_method_list(List<MethodInfo>* p_list) const
 
 	p_list->push_back(MethodInfo("call_with_kwarg"));
 
-	PyObject* obj = get_py_obj();
-	PyObject* attrs = PyObject_GenericGetDict(obj, NULL);
-	if (!attrs)
-	{
-		return;
-	}
-
-	PyObject* key, * value;
-	Py_ssize_t pos = 0;
-	while (PyDict_Next(attrs, &pos, &key, &value))
+	auto& methods = PyScript::get_introspection(get_py_obj(), m_introspection).methods;
+	for (int i = 0; i < methods.size(); ++i)
 	{
-		if (PyFunction_Check(value) || PyMethod_Check(value) || PyInstanceMethod_Check(value) || PyType_Check(value))
+		MethodInfo mi(methods[i].name);
+		for (int j = 0; j < methods[i].argc; ++j)
 		{
-			MethodInfo mi(PyScript::py2gd(key));
-			int argc = PyScript::get_py_func_argc(value);
-			for (int i = 0; i < argc; ++i)
-			{
-				mi.arguments.push_back(PropertyInfo());
-			}
-			p_list->push_back(mi);
+			mi.arguments.push_back(PropertyInfo());
 		}
+		p_list->push_back(mi);
 	}
-	Py_XDECREF(attrs);
 }
 
 bool PyScriptInstance::has_method(const StringName& p_method) const
@@ -1414,12 +2727,15 @@ bool PyScriptInstance::has_method(const StringName& p_method) const
 		return true;
 
 	PyObject* obj = get_py_obj();
-	auto method = String(p_method);
 	bool ret = false;
 	
-	if (PyObject_HasAttrString(obj, method.utf8().get_data()))
+	PyObject* attr = PyNameCache::get().get_attr(obj, p_method);
+	if (!attr)
+	{
+		PyErr_Clear();
+	}
+	else
 	{
-		PyObject* attr = PyObject_GetAttrString(obj, method.utf8().get_data());
 		ret = attr && (PyFunction_Check(attr) || PyMethod_Check(attr) || PyInstanceMethod_Check(attr) || PyType_Check(attr));
 		Py_XDECREF(attr);
 	}
@@ -1440,7 +2756,9 @@ Variant PyScriptInstance::call(const StringName& p_method, const Variant** p_arg
 	}
 
 	PyObject* kwarg = NULL;
-	auto method = p_method.operator String();
+	// Looked up as given; only call_with_kwarg names the method in a Variant.
+	const StringName* method = &p_method;
+	StringName kwargMethod;
 	if (p_method == "call_with_kwarg")
 	{
 		if (p_argcount < 2)
@@ -1466,31 +2784,32 @@ Variant PyScriptInstance::call(const StringName& p_method, const Variant** p_arg
 			return Variant();
 		}
 
-		PyObject* kwarg = PyScript::gd2py(p_args[p_argcount - 1]);
-		method = p_args[0]->operator String();
+		kwarg = PyScript::gd2py_owned(*p_args[p_argcount - 1]);
+		kwargMethod = *p_args[0];
+		method = &kwargMethod;
 		p_argcount -= 2;
 		++p_args;
 	}
 
+	PyScratchArena::Scope scope;
 	PyObject* obj = get_py_obj();
 	
 	Variant ret;
-	if (PyObject_HasAttrString(obj, method.utf8().get_data()))
+	PyObject* func = PyNameCache::get().get_attr(obj, *method);
+	if (!func)
+		PyErr_Clear();
+	if (func)
 	{
-		PyObject* func = PyObject_GetAttrString(obj, method.utf8().get_data());
-		if (func)
+		ret = PyScript::call_py_func(func, p_args, p_argcount, r_error, kwarg);
+		Py_DECREF(func);
+		if (r_error.error == Variant::CallError::CALL_OK)
 		{
-			ret = PyScript::call_py_func(func, p_args, p_argcount, r_error, kwarg);
-			Py_DECREF(func);
-			if (r_error.error == Variant::CallError::CALL_OK)
-			{
-				Py_XDECREF(kwarg);
-				return ret;
-			}
+			Py_XDECREF(kwarg);
+			return ret;
 		}
 	}
 
-	if ((method == "new" && PyType_Check(obj)) || (method == "call_self" && PyCallable_Check(obj)))
+	if ((*method == "new" && PyType_Check(obj)) || (*method == "call_self" && PyCallable_Check(obj)))
 	{
 		ret = PyScript::call_py_func(obj, p_args, p_argcount, r_error, kwarg);
 		if (r_error.error == Variant::CallError::CALL_OK)
@@ -1575,6 +2894,17 @@ PyScriptInstance& PyScriptInstance::operator =(const PyScriptInstance& p_rhs)
 	return *this;
 }
 
+// Pooled owners keep one reference for the pool; at 1 only the pool is left.
+bool PyScriptInstance::refcount_decremented()
+{
+	if (!m_pooled)
+		return true;
+	int count = Object::cast_to<Reference>(m_owner)->reference_get_count();
+	if (count == 1)
+		PyWrapperPool::get().release(this);
+	return count == 0;
+}
+
 PyScriptInstance::PyScriptInstance()
 {
 }
@@ -5,6 +5,14 @@
 #include <Python.h>
 #include "core/script_language.h"
 #include "core/func_ref.h"
+#include "core/hash_map.h"
+#include "core/self_list.h"
+#include "py_reloader.h"
+#include "py_worker.h"
+#include "py_code.h"
+#include "py_future.h"
+#include "py_signal.h"
+#include "py_wrapper_pool.h"
 
 class PyScript;
 class PyScriptInstance;
@@ -15,6 +23,31 @@ class Python : public Object
 
 private:
 	static Python* singleton;
+	int m_typedListThreshold = -1;
+	bool m_hotReload = false;
+	int m_hotReloadBudget = 1000;
+	bool m_bulkConversion = false;
+	PyWorkerPool m_workers;
+	PyReloader m_reloader;
+	PyObject* m_asyncLoop = NULL;
+	PyObject* m_asyncStop = NULL;
+	PyObject* m_asyncReady = NULL;
+	int m_asyncBudget = 2000;
+	bool m_asyncStepping = false;
+	uint64_t m_initUsec = 0;
+	uint64_t m_importUsec = 0;
+	int m_importCount = 0;
+	int m_preloadBudget = 4000;
+	int64_t m_heapBudget = 0;
+	bool m_heapOver = false;
+	List<Ref<PySignalReceiver> > m_receivers;
+
+	void _hot_reload_step();
+	void _poll_workers();
+	void _async_step();
+	void _preload_step();
+	void _heap_step();
+	PyObject* get_async_loop();
 
 protected:
 	static void _bind_methods();
@@ -27,22 +60,87 @@ public:
 	String _str(PyObject* p_obj) const;
 	Ref<Reference> iter(const Variant& p_obj);
 	Variant next(const Variant& p_iter, const Variant& p_default);
+	Variant get_attrs(const Variant& p_obj, const PoolStringArray& p_names, bool p_asArray);
+	int set_attrs(const Variant& p_obj, const Dictionary& p_values);
+	Variant getitem(const Variant& p_obj, const Variant& p_key, const String& p_attr);
+	bool setitem(const Variant& p_obj, const Variant& p_key, const Variant& p_value, const String& p_attr);
+	Variant slice(const Variant& p_obj, const Variant& p_start, const Variant& p_stop, const Variant& p_step, const String& p_attr);
+	int64_t len(const Variant& p_obj, const String& p_attr);
+	Dictionary to_columns(const Variant& p_obj, const Dictionary& p_schema, const String& p_attr);
 	bool run_file(String p_path, Vector<String> p_argv);
+	void set_typed_list_threshold(int p_threshold);
+	int get_typed_list_threshold() const;
+	void set_hot_reload(bool p_enabled);
+	bool is_hot_reload() const;
+	void set_hot_reload_budget(int p_usec);
+	int get_hot_reload_budget() const;
+	int reload_changed();
+	void set_bulk_conversion(bool p_enabled);
+	bool is_bulk_conversion() const;
+	Dictionary benchmark_conversion(const Variant& p_value, int p_iterations);
+	Dictionary benchmark_calls(int p_iterations);
+	void set_scratch_arena(bool p_enabled);
+	bool is_scratch_arena() const;
+	void set_conversion_max_depth(int p_depth);
+	int get_conversion_max_depth() const;
+	void set_conversion_max_items(int p_items);
+	int get_conversion_max_items() const;
+	int break_cycles(const Variant& p_value);
+	void set_name_cache_capacity(int p_capacity);
+	int get_name_cache_capacity() const;
+	Dictionary get_name_cache_stats() const;
+	void set_wrapper_pool_capacity(int p_capacity);
+	int get_wrapper_pool_capacity() const;
+	Dictionary get_wrapper_pool_stats() const;
+	void trim_wrapper_pool();
+	Error start_workers(int p_count, const String& p_executable, int p_ringSize);
+	void stop_workers();
+	int worker_call(const String& p_module, const String& p_function, const Array& p_args);
+	Variant worker_wait(int p_id, int p_timeoutMsec);
+	void set_worker_timeout(int p_msec);
+	int get_worker_timeout() const;
+	Ref<PySignalReceiver> connect_signal(Object* p_object, const String& p_signal, const Variant& p_callable, const Array& p_binds, int p_flags);
+	bool disconnect_signal(Object* p_object, const String& p_signal, const Variant& p_callable);
+	Ref<PyFuture> run_coroutine(const Variant& p_coroutine);
+	void step_async(int p_usec);
+	Ref<PyFunctionState> drive(const Variant& p_generator, int p_steps, int p_budgetUsec, Object* p_object, const String& p_signal);
+	void set_async_budget(int p_usec);
+	int get_async_budget() const;
+	void set_init_usec(uint64_t p_usec) { m_initUsec = p_usec; };
+	void record_import(uint64_t p_usec) { m_importUsec += p_usec; ++m_importCount; };
+	Dictionary get_startup_stats() const;
+	bool profile_imports(bool p_enabled);
+	Dictionary get_import_profile() const;
+	bool preload_modules(const PoolStringArray& p_names);
+	bool is_preloading() const;
+	void set_preload_budget(int p_usec);
+	int get_preload_budget() const;
+	void set_memory_tracing(bool p_enabled);
+	bool is_memory_tracing() const;
+	Dictionary memory_snapshot(int p_limit);
+	void set_heap_budget(int64_t p_bytes);
+	int64_t get_heap_budget() const;
+	Ref<PyCode> compile(const String& p_source, const String& p_mode);
+	Variant eval(const Ref<PyCode>& p_code, const Dictionary& p_locals);
+	Variant exec(const Ref<PyCode>& p_code, const Dictionary& p_locals);
+	PyReloader& get_reloader() { return m_reloader; };
 
 	static Python* get_singleton() { return singleton; };
 
 	Python() { singleton = this; };
-	~Python() {};
+	~Python();
 };
 
 class PyScript : public Script
 {
 	GDCLASS(PyScript, Script);
 	friend class Python;
+	friend class PyWrapperPool;
 
 private:
 	String m_moduleName;
 	PyObject* m_obj = NULL;
+	SelfList<PyScript> m_scriptList;
 	void free();
 
 protected:
@@ -54,9 +152,15 @@ protected:
 
 	static void _bind_methods();
 public:
+	static SelfList<PyScript>::List script_list;
+
 	static Variant py2gd(PyObject* p_source);
+	static bool buffer2gd(PyObject* p_source, Variant& r_ret);
+	static bool seq2pool(PyObject* p_source, Variant& r_ret);
 	static PyObject* gd2py(const Variant* p_source, bool p_tuplePriority = false);
 	static PyObject* gd2py(const Variant& p_source);
+	// gd2py as a new reference even when it is Py_None, for callers that own or steal it.
+	static PyObject* gd2py_owned(const Variant& p_source, bool p_tuplePriority = false);
 	static int get_py_func_argc(PyObject* p_func);
 	static int get_py_func_defc(PyObject* p_func);
 	static Variant call_py_func(PyObject* p_func, const Variant** p_args, int p_argcount, Variant::CallError& r_error, PyObject* p_kwargs = NULL);
@@ -69,6 +173,15 @@ public:
 		String name;
 		int argc = 0;
 	}MethodData;
+	// Attribute names of one object's __dict__, rebuilt when the dict's version tag changes.
+	typedef struct Introspection {
+		bool valid = false;
+		uint64_t version = 0;
+		Vector<MethodData> methods;
+		HashMap<StringName, int> methodArgc;
+		Vector<String> properties;
+	}Introspection;
+	static const Introspection& get_introspection(PyObject* p_obj, Introspection& r_cache);
 	Vector<MethodData> get_methods_data() const;
 	Vector<String> get_properties() const;
 
@@ -114,16 +227,23 @@ public:
 
 	PyScript();
 	~PyScript();
+
+private:
+	mutable Introspection m_introspection;
 };
 
 class PyScriptInstance : public ScriptInstance
 {
 	friend class PyScript;
 	friend class Python;
+	friend class PyWrapperPool;
 private:
 	Ref<PyScript> m_script;
 	Object* m_owner = NULL;
 	PyObject* m_obj = NULL;
+	bool m_pooled = false;
+	PyScriptInstance* m_nextFree = NULL;
+	mutable PyScript::Introspection m_introspection;
 	inline PyObject* get_py_obj() const { return m_obj; }
 	void set_py_obj(PyObject* p_obj);
 	inline void free() { Py_XDECREF(m_obj); m_obj = NULL; };
@@ -144,6 +264,7 @@ public:
 	virtual Variant call(const StringName& p_method, const Variant** p_args, int p_argcount, Variant::CallError& r_error);
 	virtual void notification(int p_notification) {};
 	virtual String to_string(bool* r_valid);
+	virtual bool refcount_decremented();
 
 	virtual Ref<Script> get_script() const;
 
@@ -1,19 +1,48 @@
 #include <core/class_db.h>
 #include "register_types.h"
 #include "pyscript.h"
+#include "godot_module.h"
+#include "py_names.h"
+#include "py_object.h"
+#include "py_export.h"
+#include "core/os/file_access.h"
 #include "core/os/os.h"
+#ifdef TOOLS_ENABLED
+#include "editor/editor_node.h"
+#endif
 
 Python* python = NULL;
+static uint64_t py_init_usec = 0;
+
+// An exported game ships its code as pyscript_bundle.zip next to the executable.
+static void py_add_bundle()
+{
+	String bundle = OS::get_singleton()->get_executable_path().get_base_dir().plus_file("pyscript_bundle.zip");
+	if (!FileAccess::exists(bundle))
+		return;
+	PyObject* path = PySys_GetObject("path");
+	PyObject* entry = PyUnicode_FromWideChar(bundle.ptr(), bundle.length());
+	if (!path || !entry || PyList_Insert(path, 0, entry) != 0)
+		print_error("Can't add the Python bundle to sys.path.");
+	Py_XDECREF(entry);
+}
 
 void py_init()
 {
 	if (Py_IsInitialized())
 		return;
 
+	uint64_t start = OS::get_singleton()->get_ticks_usec();
 	Py_SetProgramName(OS::get_singleton()->get_executable_path().ptr());
+	PyImport_AppendInittab("godot", &PyInit_godot);
 	Py_Initialize();
 	if (!Py_IsInitialized())
+	{
 		print_error("Python init failed.");
+		return;
+	}
+	py_add_bundle();
+	py_init_usec = OS::get_singleton()->get_ticks_usec() - start;
 }
 
 void py_deinit()
@@ -27,12 +56,25 @@ void register_pyscript_types()
 {
 	py_init();
 	python = memnew(Python);
+	python->set_init_usec(py_init_usec);
 	Engine::get_singleton()->add_singleton(Engine::Singleton("Python", Python::get_singleton()));
 	ClassDB::register_class<PyScript>();
+	ClassDB::register_class<PyFuture>();
+	ClassDB::register_class<PyFunctionState>();
+	ClassDB::register_class<PyCode>();
+	ClassDB::register_class<PySignalReceiver>();
+#ifdef TOOLS_ENABLED
+	ClassDB::register_class<PyExportPlugin>();
+	PyExportPlugin::register_settings();
+	EditorNode::add_init_callback(&PyExportPlugin::editor_init);
+#endif
 }
 
 void unregister_pyscript_types()
 {
 	memdelete(python);
+	PyWrapperPool::get().clear();
+	PyNameCache::get().clear();
+	object_proxy_clear_types();
 	py_deinit();
 }